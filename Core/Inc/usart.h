@@ -31,6 +31,7 @@ extern "C" {
 /* USER CODE BEGIN Includes */
 // #define DEBUG_UART huart4
 #define DEBUG_UART huart7
+#define LOG_UART huart4   // printf日志输出（DMA发送），与传输口分开
 // #define RS485_UART huart7
 #define RS485_TX_EN()   HAL_GPIO_WritePin(RS485_CTRL_GPIO_Port, RS485_CTRL_Pin, GPIO_PIN_SET)   // 发送模式
 #define RS485_RX_EN()   HAL_GPIO_WritePin(RS485_CTRL_GPIO_Port, RS485_CTRL_Pin, GPIO_PIN_RESET) // 接收模式
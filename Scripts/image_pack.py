@@ -0,0 +1,133 @@
+#!/usr/bin/env python3
+"""Pack an application binary into a bootloader image.
+
+Layout (see User/App/image.h):
+
+    slot + 0x000  header, padded with 0xFF to 0x200 bytes
+    slot + 0x200  application, linked for this address
+    ...           trailer, word aligned after the application
+
+Link the application for the slot address plus 0x200 (slot A 0x08008200,
+slot B 0x08100200) and set SCB->VTOR to the same address.
+
+Example:
+    python3 Scripts/image_pack.py app.bin app_b.img --slot B --version 1.4.0
+"""
+
+import argparse
+import struct
+import sys
+import zlib
+
+IMAGE_MAGIC = 0x474D4942  # "BIMG"
+IMAGE_TRAILER_MAGIC = 0x444E4542  # "BEND"
+IMAGE_HEADER_VERSION = 2
+IMAGE_HEADER_SIZE = 0x200
+IMAGE_FLAG_KEEP_CLOCKS = 0x01
+CRC32_HW_POLY = 0x04C11DB7
+
+SLOTS = {
+    "A": (0x08008000, 0x08100000 - 0x08008000),
+    "B": (0x08100000, 0x081C0000 - 0x08100000),
+}
+
+
+def _crc32_hw_table():
+    table = []
+    for i in range(256):
+        crc = i << 24
+        for _ in range(8):
+            crc = ((crc << 1) ^ CRC32_HW_POLY) if crc & 0x80000000 else (crc << 1)
+        table.append(crc & 0xFFFFFFFF)
+    return table
+
+
+CRC32_HW_TABLE = _crc32_hw_table()
+
+
+def crc32_hw(data):
+    """CRC of the STM32 CRC unit fed with little-endian words (CRC-32/MPEG-2)."""
+    crc = 0xFFFFFFFF
+    for (word,) in struct.iter_unpack("<I", data):
+        for byte in word.to_bytes(4, "big"):
+            crc = ((crc << 8) & 0xFFFFFFFF) ^ CRC32_HW_TABLE[(crc >> 24) ^ byte]
+    return crc
+
+
+def parse_version(text):
+    """'major.minor.patch' to major << 24 | minor << 16 | patch."""
+    parts = [int(p, 0) for p in text.split(".")]
+    if len(parts) != 3 or parts[0] > 0xFF or parts[1] > 0xFF or parts[2] > 0xFFFF:
+        raise argparse.ArgumentTypeError("version must be major.minor.patch")
+    return (parts[0] << 24) | (parts[1] << 16) | parts[2]
+
+
+def pack(app, slot, version, flags):
+    slot_address, slot_size = SLOTS[slot]
+    load_address = slot_address + IMAGE_HEADER_SIZE
+
+    if len(app) < 8:
+        sys.exit("error: application too short for a vector table")
+    stack_pointer, entry_point = struct.unpack_from("<II", app, 0)
+    if not load_address <= entry_point < load_address + len(app):
+        sys.exit(
+            "error: reset handler 0x%08X is outside 0x%08X..0x%08X, "
+            "link the application for 0x%08X" % (entry_point, load_address, load_address + len(app), load_address)
+        )
+    if stack_pointer & 3 or not 0x10000000 <= stack_pointer <= 0x20030000:
+        print("warning: initial stack pointer 0x%08X looks wrong" % stack_pointer, file=sys.stderr)
+
+    crc = zlib.crc32(app) & 0xFFFFFFFF
+    fields = struct.pack(
+        "<9I",
+        IMAGE_MAGIC,
+        IMAGE_HEADER_VERSION,
+        IMAGE_HEADER_SIZE,
+        flags,
+        version,
+        len(app),
+        load_address,
+        entry_point,
+        crc,
+    )
+    header_crc = zlib.crc32(fields) & 0xFFFFFFFF
+    header = fields + struct.pack("<I", header_crc)
+    header += b"\xff" * (IMAGE_HEADER_SIZE - len(header))
+
+    padding = b"\xff" * (-len(app) % 4)
+    trailer = struct.pack("<4I", IMAGE_TRAILER_MAGIC, len(app), crc, ~header_crc & 0xFFFFFFFF)
+
+    # Last word: the remainder so far, so the CRC unit reads 0 over the image
+    image = header + app + padding + trailer
+    image += struct.pack("<I", crc32_hw(image))
+    if len(image) > slot_size:
+        sys.exit("error: image is %d bytes, slot %s holds %d" % (len(image), slot, slot_size))
+
+    return image, load_address, crc
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("input", help="application binary (objcopy -O binary)")
+    parser.add_argument("output", help="image to send to the bootloader")
+    parser.add_argument("--slot", choices=sorted(SLOTS), required=True, help="slot the image is linked for")
+    parser.add_argument("--version", type=parse_version, default=0, help="application version, major.minor.patch")
+    parser.add_argument(
+        "--keep-clocks", action="store_true", help="start with the bootloader's PLL setup (boot_handoff.h)"
+    )
+    args = parser.parse_args()
+
+    with open(args.input, "rb") as f:
+        app = f.read()
+
+    flags = IMAGE_FLAG_KEEP_CLOCKS if args.keep_clocks else 0
+    image, load_address, crc = pack(app, args.slot, args.version, flags)
+
+    with open(args.output, "wb") as f:
+        f.write(image)
+
+    print("%s: slot %s, load 0x%08X, %d bytes, CRC 0x%08X" % (args.output, args.slot, load_address, len(image), crc))
+
+
+if __name__ == "__main__":
+    main()
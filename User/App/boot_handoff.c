@@ -0,0 +1,177 @@
+/* USER CODE BEGIN Header */
+/**
+ ******************************************************************************
+ * @file           : boot_handoff.c
+ * @brief          : Handoff block filled before the application is started
+ *
+ *          The block sits in .noinit RAM, so it survives the reset that
+ *          follows a download. The menu records the transfer there, the next
+ *          start reports it to the application once and keeps the numbers
+ *          until the next download.
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2025 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+/* USER CODE END Header */
+
+/* Includes ------------------------------------------------------------------*/
+#include "boot_handoff.h"
+#include "boot_main.h"
+#include "crc32.h"
+#include "flash_if.h"
+#include "profile.h"
+#include "serial_rx.h"
+#include "slot.h"
+
+/* Private variables ---------------------------------------------------------*/
+/* Placed right after the clock record, at BOOT_HANDOFF_BLOCK_ADDRESS */
+static BootHandoff bootHandoff __attribute__((section(".noinit.handoff")));
+
+/* Private function prototypes -----------------------------------------------*/
+static uint32_t BootHandoffGetCrc(void);
+static void BootHandoffSeal(void);
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  CRC of the block as BootHandoffCrc() computes it
+ * @note   Uses the table driven CRC, the bitwise one costs about 150 us per
+ *         pass on HSI and the fast boot path needs three passes.
+ * @retval CRC-32 of the block with the Crc field read as 0
+ */
+static uint32_t BootHandoffGetCrc(void)
+{
+    const uint32_t crc = bootHandoff.Crc;
+    uint32_t result;
+
+    bootHandoff.Crc = 0;
+    result = Crc32Update(0, (const uint8_t *)&bootHandoff, sizeof(BootHandoff));
+    bootHandoff.Crc = crc;
+
+    return result;
+}
+
+/**
+ * @brief  Stamp the header and the CRC after a change
+ * @retval None
+ */
+static void BootHandoffSeal(void)
+{
+    bootHandoff.Magic = BOOT_HANDOFF_MAGIC;
+    bootHandoff.Version = BOOT_HANDOFF_VERSION;
+    bootHandoff.Size = sizeof(BootHandoff);
+    bootHandoff.Crc = BootHandoffGetCrc();
+}
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief  Take over the block left by the previous run
+ * @note   Called at the start of every boot. A transfer that was already
+ *         reported stays in the block but no longer counts as an update.
+ * @retval None
+ */
+void BootHandoffInit(void)
+{
+    /* Written by this bootloader or garbage after power-up */
+    if ((bootHandoff.Magic != BOOT_HANDOFF_MAGIC) || (bootHandoff.Version != BOOT_HANDOFF_VERSION) ||
+        (bootHandoff.Size != sizeof(BootHandoff)) || (bootHandoff.Crc != BootHandoffGetCrc()))
+    {
+        uint32_t *word = (uint32_t *)&bootHandoff;
+        uint32_t i;
+
+        for (i = 0; i < (sizeof(BootHandoff) / sizeof(uint32_t)); i++)
+        {
+            word[i] = 0;
+        }
+    }
+    bootHandoff.Flags &= BOOT_HANDOFF_TRANSFER | BOOT_HANDOFF_PENDING;
+
+    /* Keep the reset cause for the application, start clean for the next one */
+    bootHandoff.ResetFlags = RCC->CSR;
+    RCC->CSR |= RCC_CSR_RMVF;
+
+    BootHandoffSeal();
+}
+
+/**
+ * @brief  Record the result of a download
+ * @param  status: COM_StatusTypeDef result of the receiver
+ * @param  size: bytes received
+ * @param  time: duration in milliseconds
+ * @retval None
+ */
+void BootHandoffRecordTransfer(uint32_t status, uint32_t size, uint32_t time)
+{
+    uint32_t sector, eraseTime = 0;
+
+    for (sector = 0; sector < FLASHIF_SECTOR_COUNT; sector++)
+    {
+        eraseTime += FlashIfGetEraseTime(sector);
+    }
+
+    bootHandoff.TransferStatus = status;
+    bootHandoff.TransferSize = size;
+    bootHandoff.TransferTime = time;
+    bootHandoff.TransferEraseTime = eraseTime;
+    bootHandoff.TransferProgramCycles = FlashIfGetProgramCycles();
+    bootHandoff.TransferOverruns = SerialRxGetOverruns();
+    bootHandoff.Flags |= BOOT_HANDOFF_TRANSFER | BOOT_HANDOFF_PENDING;
+
+    BootHandoffSeal();
+}
+
+/**
+ * @brief  Fill in the start that is about to happen
+ * @param  reason: BOOT_REASON_NORMAL or BOOT_REASON_FALLBACK
+ * @param  slot: slot being started
+ * @param  bootTime: microseconds since the bootloader's main(), BootGetTime()
+ *         before the clocks were put back to reset
+ * @retval None
+ */
+void BootHandoffFinish(uint32_t reason, uint32_t slot, uint32_t bootTime)
+{
+    uint32_t cold;
+
+    bootHandoff.Reason = reason;
+    bootHandoff.Slot = slot;
+    bootHandoff.ImageAddress = SlotGetImageAddress(slot);
+    bootHandoff.ImageCrc = SlotGetCrc(slot);
+    bootHandoff.ImageVersion = SlotGetVersion(slot);
+    bootHandoff.BootTime = bootTime;
+    bootHandoff.ClockTime = BootGetClockTime();
+
+    bootHandoff.VerifyTime = SlotGetVerifyTime(&cold);
+    bootHandoff.JumpCycles = PROFILE_LAST(PROFILE_SITE_JUMP);
+
+    bootHandoff.Flags &= ~(BOOT_HANDOFF_UPDATED | BOOT_HANDOFF_IMAGE_CRC | BOOT_HANDOFF_VERIFIED);
+    if (bootHandoff.ImageCrc != 0U)
+    {
+        bootHandoff.Flags |= BOOT_HANDOFF_IMAGE_CRC;
+    }
+    if (cold != 0U)
+    {
+        bootHandoff.Flags |= BOOT_HANDOFF_VERIFIED;
+    }
+
+    /* First start since a download, report it once */
+    if ((bootHandoff.Flags & BOOT_HANDOFF_PENDING) != 0U)
+    {
+        bootHandoff.Flags &= ~BOOT_HANDOFF_PENDING;
+        if (bootHandoff.TransferStatus == 0U)
+        {
+            bootHandoff.Flags |= BOOT_HANDOFF_UPDATED;
+            bootHandoff.Reason = (reason == BOOT_REASON_NORMAL) ? BOOT_REASON_UPDATE : reason;
+        }
+    }
+
+    BootHandoffSeal();
+}
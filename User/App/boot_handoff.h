@@ -0,0 +1,203 @@
+/* USER CODE BEGIN Header */
+/**
+ ******************************************************************************
+ * @file           : boot_handoff.h
+ * @brief          : Records the bootloader leaves for the application
+ *
+ *          This header is shared with the application and only needs
+ *          <stdint.h>. The records live in the last 256 bytes of SRAM1, which
+ *          the application's linker script must leave out of its RAM region
+ *          (LENGTH = 192K - 256) so its startup code and stack do not
+ *          overwrite them before main() has read them. The clock record comes
+ *          first, the handoff block follows at BOOT_HANDOFF_BLOCK_ADDRESS.
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2025 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+/* USER CODE END Header */
+
+#ifndef __BOOT_HANDOFF_H__
+#define __BOOT_HANDOFF_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+/* Start of the NOINIT region in STM32F429XX_FLASH.ld */
+#define BOOT_HANDOFF_ADDRESS ((uint32_t)0x2002FF00)
+
+#define BOOT_CLOCK_MAGIC ((uint32_t)0x4B4C4342) /* "BCLK" */
+/* Increment when fields are added, only append to the end */
+#define BOOT_CLOCK_VERSION ((uint32_t)1)
+/* Largest record a reader accepts */
+#define BOOT_CLOCK_MAX_SIZE ((uint32_t)64)
+
+/* Handoff block, after the room reserved for the clock record */
+#define BOOT_HANDOFF_BLOCK_ADDRESS (BOOT_HANDOFF_ADDRESS + BOOT_CLOCK_MAX_SIZE)
+#define BOOT_HANDOFF_MAGIC ((uint32_t)0x46464F48) /* "HOFF" */
+#define BOOT_HANDOFF_VERSION ((uint32_t)3)
+#define BOOT_HANDOFF_MAX_SIZE ((uint32_t)192)
+
+/* Why the application was started */
+#define BOOT_REASON_NORMAL ((uint32_t)0)   /* Active slot, no update requested */
+#define BOOT_REASON_FALLBACK ((uint32_t)1) /* Active slot unusable, the other slot was started */
+#define BOOT_REASON_UPDATE ((uint32_t)2)   /* First start after a download */
+
+/* BootHandoff.Flags */
+#define BOOT_HANDOFF_UPDATED ((uint32_t)0x01)   /* An update completed right before this start */
+#define BOOT_HANDOFF_TRANSFER ((uint32_t)0x02)  /* Transfer fields are filled */
+#define BOOT_HANDOFF_IMAGE_CRC ((uint32_t)0x04) /* ImageCrc is known */
+#define BOOT_HANDOFF_VERIFIED ((uint32_t)0x08)  /* The image was read in full on this boot, not found verified */
+#define BOOT_HANDOFF_PENDING ((uint32_t)0x80)   /* Bootloader internal, transfer not reported yet */
+
+    /* Exported types ------------------------------------------------------------*/
+    /* Clock tree the application is started with */
+    typedef struct
+    {
+        uint32_t Magic;       /* BOOT_CLOCK_MAGIC */
+        uint32_t Version;     /* BOOT_CLOCK_VERSION of the writer */
+        uint32_t Size;        /* sizeof(BootClockInfo) of the writer */
+        uint32_t Check;       /* ~sum of the other Size / 4 words */
+        uint32_t SysClock;    /* SYSCLK in Hz */
+        uint32_t HClock;      /* AHB clock in Hz, the value for SystemCoreClock */
+        uint32_t PClock1;     /* APB1 clock in Hz */
+        uint32_t PClock2;     /* APB2 clock in Hz */
+        uint32_t RccCr;       /* RCC->CR, oscillator and PLL enables */
+        uint32_t RccPllCfgr;  /* RCC->PLLCFGR */
+        uint32_t RccCfgr;     /* RCC->CFGR, clock source and bus dividers */
+        uint32_t FlashAcr;    /* FLASH->ACR, wait states */
+        uint32_t PwrCr;       /* PWR->CR, voltage scale and over-drive */
+    } BootClockInfo;
+
+    /* What the bootloader knows about this start */
+    typedef struct
+    {
+        uint32_t Magic;                 /* BOOT_HANDOFF_MAGIC */
+        uint32_t Version;               /* BOOT_HANDOFF_VERSION of the writer */
+        uint32_t Size;                  /* sizeof(BootHandoff) of the writer */
+        uint32_t Crc;                   /* CRC-32 of Size bytes, this field read as 0 */
+        uint32_t Reason;                /* BOOT_REASON_xxx */
+        uint32_t Flags;                 /* BOOT_HANDOFF_xxx */
+        uint32_t Slot;                  /* 0 for slot A, 1 for slot B */
+        uint32_t ImageAddress;          /* Vector table of the started image */
+        uint32_t ImageCrc;              /* CRC-32 from the image header, or of the whole file */
+        uint32_t ImageVersion;          /* 0 if the image carries no version */
+        uint32_t ResetFlags;            /* RCC->CSR at reset, the bootloader clears it */
+        uint32_t BootTime;              /* Microseconds from the bootloader's main() to the jump */
+        uint32_t ClockTime;             /* Microseconds until the PLL ran, 0 if it was not started */
+        uint32_t TransferStatus;        /* Result of the last download, 0 for success */
+        uint32_t TransferSize;          /* Bytes received */
+        uint32_t TransferTime;          /* Milliseconds */
+        uint32_t TransferEraseTime;     /* Milliseconds spent erasing */
+        uint32_t TransferProgramCycles; /* CPU cycles per KB programmed */
+        uint32_t TransferOverruns;      /* UART receive overruns */
+        uint32_t VerifyTime;            /* Microseconds spent checking the image, version 2 */
+        uint32_t JumpCycles;            /* Cycles of the shutdown before the jump, 0 without BOOT_PROFILE, version 3 */
+    } BootHandoff;
+
+    /* Exported functions ------------------------------------------------------- */
+
+    /**
+     * @brief  Check word of a clock record
+     * @note   Covers Size bytes, so a reader also accepts records of a newer
+     *         writer that appended fields.
+     * @param  info: record, Size must be at most BOOT_CLOCK_MAX_SIZE
+     * @retval Complement of the sum of all words except Check
+     */
+    static inline uint32_t BootClockInfoCheck(const BootClockInfo *info)
+    {
+        const uint32_t *word = (const uint32_t *)info;
+        uint32_t sum = 0;
+        uint32_t i;
+
+        for (i = 0; i < (info->Size / sizeof(uint32_t)); i++)
+        {
+            if (&word[i] != &info->Check)
+            {
+                sum += word[i];
+            }
+        }
+
+        return ~sum;
+    }
+
+    /**
+     * @brief  Check whether the clocks the bootloader left can be kept
+     * @note   Call first thing in main() with the live RCC->CFGR. If it returns
+     *         1, skip SystemClock_Config and set SystemCoreClock to HClock.
+     * @param  info: record at BOOT_HANDOFF_ADDRESS
+     * @param  rccCfgr: current RCC->CFGR
+     * @retval 1 if the record is intact and describes the running clock tree
+     */
+    static inline uint32_t BootClockInfoIsValid(const BootClockInfo *info, uint32_t rccCfgr)
+    {
+        return ((info->Magic == BOOT_CLOCK_MAGIC) && (info->Version >= 1U) &&
+                (info->Size >= sizeof(BootClockInfo)) && (info->Size <= BOOT_CLOCK_MAX_SIZE) &&
+                (info->Check == BootClockInfoCheck(info)) && (info->RccCfgr == rccCfgr))
+                   ? 1U
+                   : 0U;
+    }
+
+    /**
+     * @brief  CRC-32 of a handoff block
+     * @note   Bitwise, the block is small and the application may not have a
+     *         CRC table.
+     * @param  handoff: block, Size must be at most BOOT_HANDOFF_MAX_SIZE
+     * @retval CRC of Size bytes with the Crc field read as 0
+     */
+    static inline uint32_t BootHandoffCrc(const BootHandoff *handoff)
+    {
+        const uint8_t *data = (const uint8_t *)handoff;
+        const uint8_t *crcField = (const uint8_t *)&handoff->Crc;
+        uint32_t crc = 0xFFFFFFFFU;
+        uint32_t i, bit;
+
+        for (i = 0; i < handoff->Size; i++)
+        {
+            crc ^= ((&data[i] >= crcField) && (&data[i] < (crcField + sizeof(handoff->Crc)))) ? 0U : data[i];
+            for (bit = 0; bit < 8U; bit++)
+            {
+                crc = (crc >> 1) ^ ((crc & 1U) * 0xEDB88320U);
+            }
+        }
+
+        return ~crc;
+    }
+
+    /**
+     * @brief  Check a handoff block
+     * @param  handoff: block at BOOT_HANDOFF_BLOCK_ADDRESS
+     * @retval 1 if the block is intact
+     */
+    static inline uint32_t BootHandoffIsValid(const BootHandoff *handoff)
+    {
+        return ((handoff->Magic == BOOT_HANDOFF_MAGIC) && (handoff->Version >= 1U) &&
+                (handoff->Size >= sizeof(BootHandoff)) && (handoff->Size <= BOOT_HANDOFF_MAX_SIZE) &&
+                (handoff->Crc == BootHandoffCrc(handoff)))
+                   ? 1U
+                   : 0U;
+    }
+
+    /* Bootloader side, boot_handoff.c */
+    void BootHandoffInit(void);
+    void BootHandoffRecordTransfer(uint32_t status, uint32_t size, uint32_t time);
+    void BootHandoffFinish(uint32_t reason, uint32_t slot, uint32_t bootTime);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BOOT_HANDOFF_H__ */
@@ -1,14 +1,204 @@
 #include <stdbool.h>
 
+#include "boot_main.h"
+#include "boot_handoff.h"
 #include "bootloader_flag.h"
+#include "image.h"
 #include "main.h"
 #include "menu.h"
+#include "profile.h"
+#include "serial_rx.h"
+#include "slot.h"
+#include "usart.h"
 
 /* Private variables */
 typedef void (*pFunction)(void);
 pFunction jumpToApplication;
 uint32_t jumpAddress;
 
+/* HSI cycles counted from main() until the PLL was switched on */
+static uint32_t bootHsiCycles;
+
+/* Clock tree handed to the application, the linker script puts it at
+ * BOOT_HANDOFF_ADDRESS */
+static BootClockInfo bootClockInfo __attribute__((section(".noinit.clock")));
+
+/* Private function prototypes */
+static uint8_t BootIsMenuRequested(void);
+static void BootWriteClockInfo(void);
+static void BootJump(uint32_t slot, uint32_t reason, uint32_t bootTime);
+
+/**
+ * @brief  Check the upgrade flag and the DIP switches
+ * @note   Only needs the GPIOC clock, the pins are inputs after reset
+ * @retval 1 if the bootloader menu should be entered
+ */
+static uint8_t BootIsMenuRequested(void)
+{
+    if (IsBootloaderUpgradeFlagSet())
+    {
+        return 1;
+    }
+
+    return (HAL_GPIO_ReadPin(DIP2_GPIO_Port, DIP2_Pin) == GPIO_PIN_RESET &&
+            HAL_GPIO_ReadPin(DIP1_GPIO_Port, DIP1_Pin) == GPIO_PIN_RESET)
+               ? 1
+               : 0;
+}
+
+/**
+ * @brief  Describe the running clock tree for the application
+ * @retval None
+ */
+static void BootWriteClockInfo(void)
+{
+    bootClockInfo.Magic = BOOT_CLOCK_MAGIC;
+    bootClockInfo.Version = BOOT_CLOCK_VERSION;
+    bootClockInfo.Size = sizeof(BootClockInfo);
+    bootClockInfo.SysClock = HAL_RCC_GetSysClockFreq();
+    bootClockInfo.HClock = SystemCoreClock;
+    bootClockInfo.PClock1 = HAL_RCC_GetPCLK1Freq();
+    bootClockInfo.PClock2 = HAL_RCC_GetPCLK2Freq();
+    bootClockInfo.RccCr = RCC->CR;
+    bootClockInfo.RccPllCfgr = RCC->PLLCFGR;
+    bootClockInfo.RccCfgr = RCC->CFGR;
+    bootClockInfo.FlashAcr = FLASH->ACR;
+    bootClockInfo.PwrCr = PWR->CR;
+    bootClockInfo.Check = BootClockInfoCheck(&bootClockInfo);
+}
+
+/**
+ * @brief  Start the application of a slot
+ * @param  slot: SLOT_A or SLOT_B
+ * @param  reason: BOOT_REASON_xxx for the handoff block
+ * @param  bootTime: BootGetTime() taken while SystemCoreClock still matched the
+ *         cycle counter
+ * @retval None, does not return
+ */
+static void BootJump(uint32_t slot, uint32_t reason, uint32_t bootTime)
+{
+    const uint32_t applicationAddress = SlotGetImageAddress(slot);
+
+    BootWriteClockInfo();
+    PROFILE_LEAVE(PROFILE_SITE_JUMP);
+    BootHandoffFinish(reason, slot, bootTime);
+
+    /* Disable all interrupts */
+    __disable_irq();
+
+    /* Disable SysTick */
+    SysTick->CTRL = 0;
+    SysTick->LOAD = 0;
+    SysTick->VAL = 0;
+
+    /* Clear pending interrupts */
+    for (int i = 0; i < 8; i++)
+    {
+        NVIC->ICER[i] = 0xFFFFFFFF;
+        NVIC->ICPR[i] = 0xFFFFFFFF;
+    }
+
+    /* Jump to user application */
+    jumpAddress = *(__IO uint32_t *)(applicationAddress + 4);
+    jumpToApplication = (pFunction)jumpAddress;
+    /* Initialize user application's Stack Pointer */
+    __set_MSP(*(__IO uint32_t *)applicationAddress);
+    jumpToApplication();
+}
+
+/**
+ * @brief  Start a slot after the bootloader has set up its clocks and UARTs
+ * @note   The UARTs and their DMA streams are stopped. With BOOT_KEEP_CLOCKS,
+ *         or IMAGE_FLAG_KEEP_CLOCKS in the image header, the PLL stays the
+ *         system clock and the application can skip its
+ *         own clock setup after checking the record in boot_handoff.h,
+ *         otherwise the clocks are put back to their reset state.
+ * @param  slot: SLOT_A or SLOT_B
+ * @param  reason: BOOT_REASON_xxx for the handoff block
+ * @retval None, does not return
+ */
+void BootStart(uint32_t slot, uint32_t reason)
+{
+    /* HAL_RCC_DeInit() sets SystemCoreClock to the HSI, the counter ran on the PLL */
+    const uint32_t bootTime = BootGetTime();
+
+    PROFILE_ENTER(PROFILE_SITE_JUMP);
+    HAL_UART_DeInit(&huart4);
+    SerialRxStop();
+    HAL_UART_DeInit(&huart7);
+
+    /* The image header can ask for the clocks too */
+    if ((BOOT_KEEP_CLOCKS == 0) && ((SlotGetFlags(slot) & IMAGE_FLAG_KEEP_CLOCKS) == 0U))
+    {
+        HAL_RCC_DeInit();
+    }
+
+    BootJump(slot, reason, bootTime);
+}
+
+/**
+ * @brief  Boot the application before the clocks and the UARTs are set up
+ * @note   Called first thing in main(). Runs on the 16 MHz HSI with only the
+ *         GPIOC clock enabled, and returns when the menu is requested or the
+ *         active slot cannot be booted as is. An image without a record of
+ *         its full check is left to the full path as well, which reads it and
+ *         writes the record with the clocks running. The cycle counter is
+ *         started here and left running, so the application can read
+ *         DWT->CYCCNT to get the HSI cycles spent since the bootloader's main().
+ * @retval None
+ */
+void BootFastPath(void)
+{
+    uint32_t slot;
+
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    BootHandoffInit();
+
+    __HAL_RCC_GPIOC_CLK_ENABLE();
+
+    slot = SlotGetActive();
+    if ((BootIsMenuRequested() == 0U) && (SlotIsBootableFast(slot) != 0U))
+    {
+        /* Leave the RCC as the application expects it after reset */
+        __HAL_RCC_GPIOC_CLK_DISABLE();
+        PROFILE_ENTER(PROFILE_SITE_JUMP);
+        BootJump(slot, BOOT_REASON_NORMAL, BootGetTime());
+    }
+}
+
+/**
+ * @brief  Note that the system clock now runs from the PLL
+ * @note   Called after SystemClock_Config, so BootGetTime can convert the
+ *         cycles counted on either clock.
+ * @retval None
+ */
+void BootClockReady(void)
+{
+    bootHsiCycles = DWT->CYCCNT;
+    DWT->CYCCNT = 0;
+}
+
+/**
+ * @brief  Time spent on HSI before the PLL ran
+ * @retval Microseconds, 0 if the clocks were not set up
+ */
+uint32_t BootGetClockTime(void)
+{
+    return bootHsiCycles / (HSI_VALUE / 1000000U);
+}
+
+/**
+ * @brief  Time spent since main()
+ * @retval Microseconds
+ */
+uint32_t BootGetTime(void)
+{
+    return BootGetClockTime() + (DWT->CYCCNT / (SystemCoreClock / 1000000U));
+}
+
 int boot_main(void)
 {
     /* First, check for software upgrade flag */
@@ -26,42 +216,24 @@ int boot_main(void)
         /* Display main menu */
         Main_Menu();
     }
-    /* Keep the user application running */
+    /* The fast path found the active slot unusable or not yet verified */
     else
     {
-        /* Test if user code is programmed starting from address
-         * "APPLICATION_ADDRESS" */
-        uint32_t sp = *(__IO uint32_t *)APPLICATION_ADDRESS;
-        if ((sp >= 0x20000000 && sp <= 0x2001FFFF) || // SRAM1
-            (sp >= 0x20020000 && sp <= 0x2002FFFF) || // SRAM2
-            (sp >= 0x200B0000 && sp <= 0x200BFFFF))   // CCM
+        /* Boot the other slot and record it as active. A partial download
+         * only ever sits in the inactive slot. */
+        const uint32_t active = SlotGetActive();
+        const uint32_t slot = SlotGetBootSlot();
 
+        if (slot != SLOT_NONE)
         {
-            /* Disable all interrupts */
-            __disable_irq();
-
-            /* Disable SysTick */
-            SysTick->CTRL = 0;
-            SysTick->LOAD = 0;
-            SysTick->VAL = 0;
-
-            /* Clear pending interrupts */
-            for (int i = 0; i < 8; i++)
-            {
-                NVIC->ICER[i] = 0xFFFFFFFF;
-                NVIC->ICPR[i] = 0xFFFFFFFF;
-            }
-
-            /* Jump to user application */
-            jumpAddress = *(__IO uint32_t *)(APPLICATION_ADDRESS + 4);
-            jumpToApplication = (pFunction)jumpAddress;
-            /* Initialize user application's Stack Pointer */
-            __set_MSP(*(__IO uint32_t *)APPLICATION_ADDRESS);
-            jumpToApplication();
+            BootStart(slot, (slot == active) ? BOOT_REASON_NORMAL : BOOT_REASON_FALLBACK);
         }
+
+        /* No usable image, wait for a download */
+        Main_Menu();
     }
 
     while (1)
     {
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,50 @@
+/* USER CODE BEGIN Header */
+/**
+ ******************************************************************************
+ * @file           : boot_main.h
+ * @brief          : Boot decision and application start
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2025 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+/* USER CODE END Header */
+
+#ifndef __BOOT_MAIN_H__
+#define __BOOT_MAIN_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+/* Leave the PLL running when the bootloader starts the application after its
+   own clock setup (CMake option of the same name) */
+#ifndef BOOT_KEEP_CLOCKS
+#define BOOT_KEEP_CLOCKS 0
+#endif
+
+    /* Exported functions ------------------------------------------------------- */
+    void BootFastPath(void);
+    void BootClockReady(void);
+    void BootStart(uint32_t slot, uint32_t reason);
+    uint32_t BootGetClockTime(void);
+    uint32_t BootGetTime(void);
+    int boot_main(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BOOT_MAIN_H__ */
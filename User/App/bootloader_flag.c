@@ -19,15 +19,20 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "bootloader_flag.h"
-#include "stm32f4xx_hal.h"
+#include "flash_if.h"
+#include "store.h"
 #include <stdio.h>
 
+/* Private define ------------------------------------------------------------*/
+#define BOOTLOADER_FLAG_BKP ((&RTC->BKP0R)[BOOTLOADER_FLAG_BKP_INDEX])
+
 /* Private variables ---------------------------------------------------------*/
 
 /* Private function prototypes -----------------------------------------------*/
-static HAL_StatusTypeDef FlashEraseFlagSector(void);
-static HAL_StatusTypeDef FlashWriteFlagData(const BootloaderFlag *flagData);
 static const BootloaderFlag *GetBootloaderFlagPtr(void);
+static uint8_t IsLegacyFlagSet(void);
+static uint8_t IsBackupRequestSet(void);
+static void WriteBackupRequest(uint32_t value);
 
 /* Private functions ---------------------------------------------------------*/
 
@@ -41,120 +46,72 @@ static const BootloaderFlag *GetBootloaderFlagPtr(void)
 }
 
 /**
- * @brief  Erase the Flash sector containing bootloader flag
- * @retval HAL_OK if successful, HAL_ERROR otherwise
+ * @brief  Check the flag written by applications built against the old layout
+ * @retval 1 if the legacy flag is set, 0 otherwise
  */
-static HAL_StatusTypeDef FlashEraseFlagSector(void)
+static uint8_t IsLegacyFlagSet(void)
 {
-    FLASH_EraseInitTypeDef eraseInitStruct;
-    uint32_t sectorError;
-
-    // 解锁Flash
-    HAL_StatusTypeDef status = HAL_FLASH_Unlock();
-    if (status != HAL_OK)
-    {
-        printf("Flash unlock failed: %d\r\n", status);
-        return status;
-    }
-
-    // 配置擦除参数
-    eraseInitStruct.TypeErase = FLASH_TYPEERASE_SECTORS;
-    eraseInitStruct.VoltageRange = FLASH_VOLTAGE_RANGE_3; // 2.7V-3.6V
-    eraseInitStruct.Sector = BOOTLOADER_FLAG_SECTOR;
-    eraseInitStruct.NbSectors = 1;
-
-    // 执行扇区擦除
-    status = HAL_FLASHEx_Erase(&eraseInitStruct, &sectorError);
-    if (status != HAL_OK)
-    {
-        printf("Flash erase failed: %d, sector error: %u\r\n", status, (unsigned int)sectorError);
-        HAL_FLASH_Lock();
-        return status;
-    }
-
-    // 锁定Flash
-    HAL_FLASH_Lock();
+    const BootloaderFlag *flagPtr = GetBootloaderFlagPtr();
 
-    printf("Flash sector %lu erased successfully\r\n", (unsigned long)BOOTLOADER_FLAG_SECTOR);
-    return HAL_OK;
+    return (flagPtr->MagicValue == BOOTLOADER_FLAG_MAGIC && flagPtr->BootFlag == BOOTLOADER_FLAG_UPGRADE) ? 1 : 0;
 }
 
 /**
- * @brief  Write bootloader flag data to Flash
- * @param  flagData: Pointer to flag data structure
- * @retval HAL_OK if successful, HAL_ERROR otherwise
+ * @brief  Check the request left in the backup register before a reset
+ * @note   Reading needs no clock and no unlock
+ * @retval 1 if the request is set, 0 otherwise
  */
-static HAL_StatusTypeDef FlashWriteFlagData(const BootloaderFlag *flagData)
+static uint8_t IsBackupRequestSet(void)
 {
-    uint32_t address = BOOTLOADER_FLAG_ADDRESS;
-
-    // 解锁Flash
-    HAL_StatusTypeDef status = HAL_FLASH_Unlock();
-    if (status != HAL_OK)
-    {
-        printf("Flash unlock failed: %d\r\n", status);
-        return status;
-    }
+    return (BOOTLOADER_FLAG_BKP == BOOTLOADER_FLAG_BKP_REQUEST) ? 1 : 0;
+}
 
-    // 写入magic字段 (32位)
-    status = HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, address, flagData->MagicValue);
-    if (status != HAL_OK)
-    {
-        printf("Flash write magic failed: %d\r\n", status);
-        HAL_FLASH_Lock();
-        return status;
-    }
+/**
+ * @brief  Write the backup register
+ * @note   The backup domain is write protected again afterwards
+ * @param  value: BOOTLOADER_FLAG_BKP_REQUEST or 0
+ * @retval None
+ */
+static void WriteBackupRequest(uint32_t value)
+{
+    __HAL_RCC_PWR_CLK_ENABLE();
+    HAL_PWR_EnableBkUpAccess();
+    BOOTLOADER_FLAG_BKP = value;
+    HAL_PWR_DisableBkUpAccess();
+}
 
-    // 写入flag字段 (32位)
-    address += 4;
-    status = HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, address, flagData->BootFlag);
-    if (status != HAL_OK)
-    {
-        printf("Flash write flag failed: %d\r\n", status);
-        HAL_FLASH_Lock();
-        return status;
-    }
+/* Public functions ----------------------------------------------------------*/
 
-    // 锁定Flash
-    HAL_FLASH_Lock();
+/**
+ * @brief  Request the bootloader menu for the next reset
+ * @note   Uses the RTC backup register, which keeps its value over a system
+ *         reset: no Flash is erased or programmed.
+ * @retval 1 if the request was stored, 0 if the backup register did not take it
+ */
+uint8_t SetBootloaderUpgradeRequest(void)
+{
+    WriteBackupRequest(BOOTLOADER_FLAG_BKP_REQUEST);
 
-    printf("Bootloader flag written to Flash at 0x%08lX\r\n", (unsigned long)BOOTLOADER_FLAG_ADDRESS);
-    return HAL_OK;
+    return IsBackupRequestSet();
 }
 
-/* Public functions ----------------------------------------------------------*/
-
 /**
  * @brief  Set bootloader upgrade flag in Flash
+ * @note   Appends one record to the store, the sector is not erased. Survives
+ *         a power cycle, unlike SetBootloaderUpgradeRequest.
  * @retval None
  */
 void SetBootloaderUpgradeFlag(void)
 {
-    BootloaderFlag flagData;
-
-    // 准备标志位数据
-    flagData.MagicValue = BOOTLOADER_FLAG_MAGIC;
-    flagData.BootFlag = BOOTLOADER_FLAG_UPGRADE;
-
     printf("Setting bootloader upgrade flag...\r\n");
 
-    // 先擦除Flash扇区
-    HAL_StatusTypeDef status = FlashEraseFlagSector();
-    if (status != HAL_OK)
-    {
-        printf("Failed to erase Flash sector for bootloader flag\r\n");
-        return;
-    }
-
-    // 写入标志位数据
-    status = FlashWriteFlagData(&flagData);
-    if (status != HAL_OK)
+    if (StoreSet(STORE_KEY_UPGRADE, 1) != STORE_OK)
     {
         printf("Failed to write bootloader flag to Flash\r\n");
         return;
     }
 
-    printf("Bootloader upgrade flag set successfully at address 0x%08lX\r\n", (unsigned long)BOOTLOADER_FLAG_ADDRESS);
+    printf("Bootloader upgrade flag set successfully\r\n");
 }
 
 /**
@@ -163,12 +120,31 @@ void SetBootloaderUpgradeFlag(void)
  */
 void ClearBootloaderFlag(void)
 {
+    uint32_t status = STORE_OK;
 
     printf("Clearing bootloader flag...\r\n");
 
-    // 擦除整个扇区即可清除标志位
-    HAL_StatusTypeDef status = FlashEraseFlagSector();
-    if (status != HAL_OK)
+    if (IsBackupRequestSet())
+    {
+        WriteBackupRequest(0);
+    }
+
+    // 只有Flash中确实存在标志位时才写Flash
+    // 旧版应用写入的标志位：把BootFlag清零即可，无需擦除扇区
+    if (IsLegacyFlagSet())
+    {
+        FlashIfInit();
+        if (HAL_FLASH_Program(TYPEPROGRAM_WORD, BOOTLOADER_FLAG_ADDRESS + 4U, 0) != HAL_OK)
+        {
+            status = STORE_WRITE_ERROR;
+        }
+    }
+    if ((StoreGet(STORE_KEY_UPGRADE, 0) != 0U) && (StoreSet(STORE_KEY_UPGRADE, 0) != STORE_OK))
+    {
+        status = STORE_WRITE_ERROR;
+    }
+
+    if (status != STORE_OK)
     {
         printf("Failed to clear bootloader flag\r\n");
         return;
@@ -177,16 +153,29 @@ void ClearBootloaderFlag(void)
     printf("Bootloader flag cleared successfully\r\n");
 }
 
+/**
+ * @brief  Check the upgrade flag without printing
+ * @note   Safe to call before the clocks and the UART are set up
+ * @retval 1 if upgrade flag is set, 0 otherwise
+ */
+uint8_t IsBootloaderUpgradeFlagSet(void)
+{
+    return (IsBackupRequestSet() || (StoreGet(STORE_KEY_UPGRADE, 0) != 0U) || IsLegacyFlagSet()) ? 1 : 0;
+}
+
 /**
  * @brief  Check if bootloader upgrade flag is set
  * @retval 1 if upgrade flag is set, 0 otherwise
  */
 uint8_t CheckBootloaderUpgradeFlag(void)
 {
-    const BootloaderFlag *flagPtr = GetBootloaderFlagPtr();
-
-    // 检查Flash中的标志位
-    if (flagPtr->MagicValue == BOOTLOADER_FLAG_MAGIC && flagPtr->BootFlag == BOOTLOADER_FLAG_UPGRADE)
+    // 先检查备份寄存器中的请求，再检查Flash中的标志位
+    if (IsBackupRequestSet())
+    {
+        printf("Bootloader upgrade request detected in backup register\r\n");
+        return 1;
+    }
+    if (IsBootloaderUpgradeFlagSet())
     {
         printf("Bootloader upgrade flag detected in Flash\r\n");
         return 1;
@@ -204,8 +193,12 @@ void TriggerSystemResetToBootloader(void)
 {
     printf("Triggering system reset to bootloader...\r\n");
 
-    // 设置bootloader升级标志位到Flash
-    SetBootloaderUpgradeFlag();
+    // 优先使用RTC备份寄存器，失败时才写Flash标志位
+    if (!SetBootloaderUpgradeRequest())
+    {
+        printf("Backup register not writable, using the Flash flag\r\n");
+        SetBootloaderUpgradeFlag();
+    }
 
     printf("System will reset now...\r\n");
 
@@ -32,13 +32,18 @@ extern "C"
 // STM32F429 Flash扇区布局 (最后几个扇区):
 // Sector 21: 0x081A0000-0x081BFFFF (128KB)
 // Sector 22: 0x081C0000-0x081DFFFF (128KB)
-// Sector 23: 0x081E0000-0x081FFFFF (128KB) <- 用于标志位存储
-// 使用Flash Sector 23的末尾存储bootloader标志位
+// Sector 23: 0x081E0000-0x081FFFFF (128KB) <- 用于标志位存储 (store.c)
+// 标志位以追加记录的方式保存在扇区23前部，末尾256字节保留给旧版应用写入的标志位
 #define BOOTLOADER_FLAG_SECTOR 23            // Flash扇区23
 #define BOOTLOADER_FLAG_ADDRESS 0x081FFF00UL // 扇区23末尾预留256字节用于标志位
 #define BOOTLOADER_FLAG_MAGIC 0x12345678UL   // 魔数，用于验证标志位的有效性
 #define BOOTLOADER_FLAG_UPGRADE 0xABCDEF00UL // 升级标志
 
+// 复位进入bootloader的请求优先写入RTC备份寄存器BKP19R，软复位后保持不变，无需擦写Flash；
+// 只有备份寄存器写入失败时才退回到Flash标志位
+#define BOOTLOADER_FLAG_BKP_INDEX 19             // RTC备份寄存器编号
+#define BOOTLOADER_FLAG_BKP_REQUEST 0x55504752UL // 请求值 "UPGR"
+
     /* Bootloader flag structure */
     typedef struct
     {
@@ -48,8 +53,10 @@ extern "C"
 
     /* Function prototypes -------------------------------------------------------*/
     void SetBootloaderUpgradeFlag(void);
+    uint8_t SetBootloaderUpgradeRequest(void);
     void ClearBootloaderFlag(void);
     uint8_t CheckBootloaderUpgradeFlag(void);
+    uint8_t IsBootloaderUpgradeFlagSet(void);
     void TriggerSystemResetToBootloader(void);
 
 #ifdef __cplusplus
@@ -23,6 +23,7 @@
 /* Includes ------------------------------------------------------------------*/
 #include "common.h"
 #include "main.h"
+#include "profile.h"
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
@@ -34,7 +35,7 @@
 /**
  * @brief  Convert an Integer to a string
  * @param pStr
- * @param  p_str: The string output pointer
+ * @param  p_str: The string output pointer, 11 bytes
  * @param  intnum: The integer to be converted
  * @retval None
  */
@@ -59,6 +60,13 @@ void Int2Str(uint8_t *pStr, uint32_t intnum)
             status++;
         }
     }
+
+    /* Zero has no leading digit, and the buffer may hold a longer number */
+    if (pos == 0)
+    {
+        pStr[pos++] = '0';
+    }
+    pStr[pos] = '\0';
 }
 
 /**
@@ -163,6 +171,7 @@ void SerialPutString(const uint8_t *pString)
  */
 HAL_StatusTypeDef SerialPutByte(uint8_t param)
 {
+    PROFILE_ENTER(PROFILE_SITE_PUTBYTE);
     /* May be timeouted... */
     if (DEBUG_UART.gState == HAL_UART_STATE_TIMEOUT)
     {
@@ -171,6 +180,7 @@ HAL_StatusTypeDef SerialPutByte(uint8_t param)
     RS485_TX_EN();
     HAL_StatusTypeDef status = HAL_UART_Transmit(&DEBUG_UART, &param, 1, TX_TIMEOUT);
     RS485_RX_EN();
+    PROFILE_LEAVE(PROFILE_SITE_PUTBYTE);
     return status;
 }
 /**
@@ -0,0 +1,151 @@
+/* USER CODE BEGIN Header */
+/**
+ ******************************************************************************
+ * @file           : crc16.c
+ * @brief          : CRC16-CCITT (XMODEM) used by the YMODEM packets
+ *
+ *          Polynomial 0x1021, initial value 0, MSB first. The lookup tables are
+ *          built by the preprocessor: the CRC is linear, so an entry is the XOR
+ *          of the entries of its set bits, and the per-bit entries of table k
+ *          are x^(16 + 8k + b) mod P, each one shift away from the previous.
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2025 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+/* USER CODE END Header */
+
+/* Includes ------------------------------------------------------------------*/
+#include "crc16.h"
+
+#if (CRC16_IMPL != CRC16_IMPL_BITWISE)
+
+/* Private define ------------------------------------------------------------*/
+/* One bit of CRC register shift */
+#define CRC16_SHIFT(c) (((((uint32_t)(c)) << 1) ^ (((((uint32_t)(c)) >> 15) & 1U) * CRC16_POLY)) & 0xFFFFU)
+
+/* Table k entry of data byte i, i.e. the CRC of i followed by k zero bytes */
+#define CRC16_ENTRY(k, i)                                                                                              \
+    ((uint16_t)((((i) & 0x01U) ? CRC16_K##k##_0 : 0U) ^ (((i) & 0x02U) ? CRC16_K##k##_1 : 0U) ^                      \
+                (((i) & 0x04U) ? CRC16_K##k##_2 : 0U) ^ (((i) & 0x08U) ? CRC16_K##k##_3 : 0U) ^                      \
+                (((i) & 0x10U) ? CRC16_K##k##_4 : 0U) ^ (((i) & 0x20U) ? CRC16_K##k##_5 : 0U) ^                      \
+                (((i) & 0x40U) ? CRC16_K##k##_6 : 0U) ^ (((i) & 0x80U) ? CRC16_K##k##_7 : 0U)))
+
+#define CRC16_ROW4(k, i)                                                                                               \
+    CRC16_ENTRY(k, (i)), CRC16_ENTRY(k, (i) + 1U), CRC16_ENTRY(k, (i) + 2U), CRC16_ENTRY(k, (i) + 3U)
+#define CRC16_ROW16(k, i)                                                                                              \
+    CRC16_ROW4(k, (i)), CRC16_ROW4(k, (i) + 4U), CRC16_ROW4(k, (i) + 8U), CRC16_ROW4(k, (i) + 12U)
+#define CRC16_ROW64(k, i)                                                                                              \
+    CRC16_ROW16(k, (i)), CRC16_ROW16(k, (i) + 16U), CRC16_ROW16(k, (i) + 32U), CRC16_ROW16(k, (i) + 48U)
+#define CRC16_TABLE(k) {CRC16_ROW64(k, 0U), CRC16_ROW64(k, 64U), CRC16_ROW64(k, 128U), CRC16_ROW64(k, 192U)}
+
+/* Private typedef -----------------------------------------------------------*/
+/* Entry of data bit b in table k */
+enum
+{
+    CRC16_K0_0 = CRC16_POLY, /* x^16 mod P */
+    CRC16_K0_1 = CRC16_SHIFT(CRC16_K0_0),
+    CRC16_K0_2 = CRC16_SHIFT(CRC16_K0_1),
+    CRC16_K0_3 = CRC16_SHIFT(CRC16_K0_2),
+    CRC16_K0_4 = CRC16_SHIFT(CRC16_K0_3),
+    CRC16_K0_5 = CRC16_SHIFT(CRC16_K0_4),
+    CRC16_K0_6 = CRC16_SHIFT(CRC16_K0_5),
+    CRC16_K0_7 = CRC16_SHIFT(CRC16_K0_6),
+#if (CRC16_IMPL == CRC16_IMPL_SLICE4)
+    CRC16_K1_0 = CRC16_SHIFT(CRC16_K0_7),
+    CRC16_K1_1 = CRC16_SHIFT(CRC16_K1_0),
+    CRC16_K1_2 = CRC16_SHIFT(CRC16_K1_1),
+    CRC16_K1_3 = CRC16_SHIFT(CRC16_K1_2),
+    CRC16_K1_4 = CRC16_SHIFT(CRC16_K1_3),
+    CRC16_K1_5 = CRC16_SHIFT(CRC16_K1_4),
+    CRC16_K1_6 = CRC16_SHIFT(CRC16_K1_5),
+    CRC16_K1_7 = CRC16_SHIFT(CRC16_K1_6),
+    CRC16_K2_0 = CRC16_SHIFT(CRC16_K1_7),
+    CRC16_K2_1 = CRC16_SHIFT(CRC16_K2_0),
+    CRC16_K2_2 = CRC16_SHIFT(CRC16_K2_1),
+    CRC16_K2_3 = CRC16_SHIFT(CRC16_K2_2),
+    CRC16_K2_4 = CRC16_SHIFT(CRC16_K2_3),
+    CRC16_K2_5 = CRC16_SHIFT(CRC16_K2_4),
+    CRC16_K2_6 = CRC16_SHIFT(CRC16_K2_5),
+    CRC16_K2_7 = CRC16_SHIFT(CRC16_K2_6),
+    CRC16_K3_0 = CRC16_SHIFT(CRC16_K2_7),
+    CRC16_K3_1 = CRC16_SHIFT(CRC16_K3_0),
+    CRC16_K3_2 = CRC16_SHIFT(CRC16_K3_1),
+    CRC16_K3_3 = CRC16_SHIFT(CRC16_K3_2),
+    CRC16_K3_4 = CRC16_SHIFT(CRC16_K3_3),
+    CRC16_K3_5 = CRC16_SHIFT(CRC16_K3_4),
+    CRC16_K3_6 = CRC16_SHIFT(CRC16_K3_5),
+    CRC16_K3_7 = CRC16_SHIFT(CRC16_K3_6),
+#endif
+};
+
+/* Private variables ---------------------------------------------------------*/
+static const uint16_t aCrc16Table0[256] = CRC16_TABLE(0);
+#if (CRC16_IMPL == CRC16_IMPL_SLICE4)
+static const uint16_t aCrc16Table1[256] = CRC16_TABLE(1);
+static const uint16_t aCrc16Table2[256] = CRC16_TABLE(2);
+static const uint16_t aCrc16Table3[256] = CRC16_TABLE(3);
+#endif
+
+#endif /* CRC16_IMPL != CRC16_IMPL_BITWISE */
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief  Continue a CRC16 over a block of data
+ * @param  crc: CRC of the preceding data, 0 to start
+ * @param  data: pointer to input data
+ * @param  size: length of input data
+ * @retval Updated CRC
+ */
+uint16_t Crc16Update(uint16_t crc, const uint8_t *data, uint32_t size)
+{
+    const uint8_t *dataEnd = data + size;
+
+#if (CRC16_IMPL == CRC16_IMPL_SLICE4)
+    while ((dataEnd - data) >= 4)
+    {
+        crc = aCrc16Table3[(crc >> 8) ^ data[0]] ^ aCrc16Table2[(crc & 0xFFU) ^ data[1]] ^
+              aCrc16Table1[data[2]] ^ aCrc16Table0[data[3]];
+        data += 4;
+    }
+#endif
+
+#if (CRC16_IMPL == CRC16_IMPL_BITWISE)
+    while (data < dataEnd)
+    {
+        uint32_t i;
+
+        crc ^= (uint16_t)(*data++ << 8);
+        for (i = 0; i < 8U; i++)
+        {
+            crc = (crc & 0x8000U) ? (uint16_t)((crc << 1) ^ CRC16_POLY) : (uint16_t)(crc << 1);
+        }
+    }
+#else
+    while (data < dataEnd)
+    {
+        crc = (uint16_t)(crc << 8) ^ aCrc16Table0[(crc >> 8) ^ *data++];
+    }
+#endif
+
+    return crc;
+}
+
+/**
+ * @brief  Cal CRC16 for YModem Packet
+ * @param  data
+ * @param  length
+ * @retval CRC16 of the data
+ */
+uint16_t CalCrC16(const uint8_t *data, uint32_t size)
+{
+    return Crc16Update(0, data, size);
+}
@@ -0,0 +1,54 @@
+/* USER CODE BEGIN Header */
+/**
+ ******************************************************************************
+ * @file           : crc16.h
+ * @brief          : CRC16-CCITT (XMODEM) used by the YMODEM packets
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2025 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+/* USER CODE END Header */
+
+#ifndef __CRC16_H__
+#define __CRC16_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+/* Available implementations, selected with CRC16_IMPL (CMake option of the same name)
+   BITWISE: one bit per iteration, no table
+   TABLE  : one 256 entry table, 512 bytes of flash
+   SLICE4 : four 256 entry tables processing 4 bytes per iteration, 2 KB of flash */
+#define CRC16_IMPL_BITWISE 0
+#define CRC16_IMPL_TABLE 1
+#define CRC16_IMPL_SLICE4 2
+
+#ifndef CRC16_IMPL
+#define CRC16_IMPL CRC16_IMPL_TABLE
+#endif
+
+#define CRC16_POLY 0x1021U
+
+    /* Exported functions ------------------------------------------------------- */
+    uint16_t Crc16Update(uint16_t crc, const uint8_t *data, uint32_t size);
+    uint16_t CalCrC16(const uint8_t *data, uint32_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CRC16_H__ */
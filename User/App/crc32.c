@@ -0,0 +1,75 @@
+/* USER CODE BEGIN Header */
+/**
+ ******************************************************************************
+ * @file           : crc32.c
+ * @brief          : CRC-32 (IEEE 802.3) used by the extended YMODEM blocks
+ *
+ *          Reflected polynomial 0xEDB88320, initial value and final XOR
+ *          0xFFFFFFFF, the same result as zlib crc32(). The table is built by
+ *          the preprocessor the same way as the CRC16 one (see crc16.c).
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2025 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+/* USER CODE END Header */
+
+/* Includes ------------------------------------------------------------------*/
+#include "crc32.h"
+
+/* Private define ------------------------------------------------------------*/
+/* One bit of CRC register shift */
+#define CRC32_SHIFT(c) ((((uint32_t)(c)) >> 1) ^ ((((uint32_t)(c)) & 1U) * CRC32_POLY_REFLECTED))
+
+/* Table entry of data byte i */
+#define CRC32_ENTRY(i)                                                                                                 \
+    ((uint32_t)((((i) & 0x01U) ? CRC32_K0 : 0U) ^ (((i) & 0x02U) ? CRC32_K1 : 0U) ^                                  \
+                (((i) & 0x04U) ? CRC32_K2 : 0U) ^ (((i) & 0x08U) ? CRC32_K3 : 0U) ^                                  \
+                (((i) & 0x10U) ? CRC32_K4 : 0U) ^ (((i) & 0x20U) ? CRC32_K5 : 0U) ^                                  \
+                (((i) & 0x40U) ? CRC32_K6 : 0U) ^ (((i) & 0x80U) ? CRC32_K7 : 0U)))
+
+#define CRC32_ROW4(i) CRC32_ENTRY(i), CRC32_ENTRY((i) + 1U), CRC32_ENTRY((i) + 2U), CRC32_ENTRY((i) + 3U)
+#define CRC32_ROW16(i) CRC32_ROW4(i), CRC32_ROW4((i) + 4U), CRC32_ROW4((i) + 8U), CRC32_ROW4((i) + 12U)
+#define CRC32_ROW64(i) CRC32_ROW16(i), CRC32_ROW16((i) + 16U), CRC32_ROW16((i) + 32U), CRC32_ROW16((i) + 48U)
+
+/* Entry of data bit b, the top bit is one shift away from the polynomial */
+#define CRC32_K7 CRC32_POLY_REFLECTED
+#define CRC32_K6 CRC32_SHIFT(CRC32_K7)
+#define CRC32_K5 CRC32_SHIFT(CRC32_K6)
+#define CRC32_K4 CRC32_SHIFT(CRC32_K5)
+#define CRC32_K3 CRC32_SHIFT(CRC32_K4)
+#define CRC32_K2 CRC32_SHIFT(CRC32_K3)
+#define CRC32_K1 CRC32_SHIFT(CRC32_K2)
+#define CRC32_K0 CRC32_SHIFT(CRC32_K1)
+
+/* Private variables ---------------------------------------------------------*/
+static const uint32_t aCrc32Table[256] = {CRC32_ROW64(0U), CRC32_ROW64(64U), CRC32_ROW64(128U), CRC32_ROW64(192U)};
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief  Continue a CRC-32 over a block of data
+ * @param  crc: CRC of the preceding data, 0 to start
+ * @param  data: pointer to input data
+ * @param  size: length of input data
+ * @retval Updated CRC
+ */
+uint32_t Crc32Update(uint32_t crc, const uint8_t *data, uint32_t size)
+{
+    const uint8_t *dataEnd = data + size;
+
+    crc = ~crc;
+    while (data < dataEnd)
+    {
+        crc = (crc >> 8) ^ aCrc32Table[(crc ^ *data++) & 0xFFU];
+    }
+
+    return ~crc;
+}
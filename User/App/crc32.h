@@ -0,0 +1,41 @@
+/* USER CODE BEGIN Header */
+/**
+ ******************************************************************************
+ * @file           : crc32.h
+ * @brief          : CRC-32 (IEEE 802.3) used by the extended YMODEM blocks
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2025 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+/* USER CODE END Header */
+
+#ifndef __CRC32_H__
+#define __CRC32_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+#define CRC32_POLY_REFLECTED 0xEDB88320UL
+
+    /* Exported functions ------------------------------------------------------- */
+    uint32_t Crc32Update(uint32_t crc, const uint8_t *data, uint32_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CRC32_H__ */
@@ -0,0 +1,102 @@
+/* USER CODE BEGIN Header */
+/**
+ ******************************************************************************
+ * @file           : crc32_hw.c
+ * @brief          : CRC unit fed by memory-to-memory DMA
+ *
+ *          DMA2 stream 0 copies words from Flash into CRC->DR, the only DMA
+ *          controller that can do memory-to-memory transfers. The CPU only
+ *          waits, so a 1 MB image takes about as long as the bus needs to
+ *          read it.
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2025 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+/* USER CODE END Header */
+
+/* Includes ------------------------------------------------------------------*/
+#include "crc32_hw.h"
+
+/* Private define ------------------------------------------------------------*/
+/* Words per DMA transfer, NDTR is 16 bits */
+#define CRC32_HW_CHUNK ((uint32_t)0xFFFC)
+/* Milliseconds a chunk may take, about 25 ms on the 16 MHz HSI */
+#define CRC32_HW_TIMEOUT ((uint32_t)100)
+
+/* Private variables ---------------------------------------------------------*/
+static DMA_HandleTypeDef hdmaCrc;
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief  Run a word aligned block through the CRC unit
+ * @note   Blocks until done. Works before HAL_Init as well, the DMA is
+ *         polled; the tick stands still then, so only a DMA error ends a
+ *         stuck transfer early.
+ * @param  address: first word
+ * @param  words: number of 32-bit words
+ * @retval CRC-32/MPEG-2 of the block, see CRC32_HW_POLY
+ */
+uint32_t Crc32HwCompute(uint32_t address, uint32_t words)
+{
+    const uint32_t start = address;
+    const uint32_t total = words;
+    uint32_t chunk, result;
+
+    __HAL_RCC_CRC_CLK_ENABLE();
+    __HAL_RCC_DMA2_CLK_ENABLE();
+
+    hdmaCrc.Instance = DMA2_Stream0;
+    hdmaCrc.Init.Channel = DMA_CHANNEL_0;
+    hdmaCrc.Init.Direction = DMA_MEMORY_TO_MEMORY;
+    hdmaCrc.Init.PeriphInc = DMA_PINC_ENABLE; /* Source in memory-to-memory mode */
+    hdmaCrc.Init.MemInc = DMA_MINC_DISABLE;   /* CRC->DR */
+    hdmaCrc.Init.PeriphDataAlignment = DMA_PDATAALIGN_WORD;
+    hdmaCrc.Init.MemDataAlignment = DMA_MDATAALIGN_WORD;
+    hdmaCrc.Init.Mode = DMA_NORMAL;
+    hdmaCrc.Init.Priority = DMA_PRIORITY_HIGH;
+    hdmaCrc.Init.FIFOMode = DMA_FIFOMODE_ENABLE; /* Direct mode is not allowed memory-to-memory */
+    hdmaCrc.Init.FIFOThreshold = DMA_FIFO_THRESHOLD_FULL;
+    hdmaCrc.Init.MemBurst = DMA_MBURST_SINGLE;
+    hdmaCrc.Init.PeriphBurst = DMA_PBURST_SINGLE; /* Bursts would need a multiple of four words */
+    (void)HAL_DMA_Init(&hdmaCrc);
+
+    CRC->CR = CRC_CR_RESET;
+
+    while (words > 0U)
+    {
+        chunk = (words > CRC32_HW_CHUNK) ? CRC32_HW_CHUNK : words;
+
+        if ((HAL_DMA_Start(&hdmaCrc, address, (uint32_t)&CRC->DR, chunk) != HAL_OK) ||
+            (HAL_DMA_PollForTransfer(&hdmaCrc, HAL_DMA_FULL_TRANSFER, CRC32_HW_TIMEOUT) != HAL_OK))
+        {
+            /* Part of the chunk may be in, start over with the CPU */
+            (void)HAL_DMA_Abort(&hdmaCrc);
+            CRC->CR = CRC_CR_RESET;
+            for (address = start, words = total; words > 0U; words--, address += 4U)
+            {
+                CRC->DR = *(__IO uint32_t *)address;
+            }
+            break;
+        }
+
+        address += chunk * 4U;
+        words -= chunk;
+    }
+
+    result = CRC->DR;
+
+    (void)HAL_DMA_DeInit(&hdmaCrc);
+    __HAL_RCC_DMA2_CLK_DISABLE();
+    __HAL_RCC_CRC_CLK_DISABLE();
+
+    return result;
+}
@@ -0,0 +1,44 @@
+/* USER CODE BEGIN Header */
+/**
+ ******************************************************************************
+ * @file           : crc32_hw.h
+ * @brief          : CRC unit fed by memory-to-memory DMA
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2025 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+/* USER CODE END Header */
+
+#ifndef __CRC32_HW_H__
+#define __CRC32_HW_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f4xx_hal.h"
+
+/* Exported constants --------------------------------------------------------*/
+/* The CRC unit computes CRC-32/MPEG-2: polynomial 0x04C11DB7, initial value
+   0xFFFFFFFF, 32-bit words taken most significant bit first, no final XOR.
+   This is not the CRC-32 of crc32.h. */
+#define CRC32_HW_POLY 0x04C11DB7UL
+
+    /* Exported functions ------------------------------------------------------- */
+    uint32_t Crc32HwCompute(uint32_t address, uint32_t words);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CRC32_HW_H__ */
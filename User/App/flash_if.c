@@ -22,13 +22,70 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "flash_if.h"
+#include "crc32.h"
+#include "profile.h"
 
 /* Private typedef -----------------------------------------------------------*/
+/**
+ * @brief  Pending write of one packet buffer
+ */
+typedef struct
+{
+    uint32_t address; /* Next flash address to program */
+    uint32_t *data;   /* Next word to program */
+    uint32_t length;  /* Words left */
+} FlashIfJob;
+
 /* Private define ------------------------------------------------------------*/
+#define FLASHIF_ERROR_FLAGS                                                                                            \
+    (FLASH_FLAG_OPERR | FLASH_FLAG_WRPERR | FLASH_FLAG_PGAERR | FLASH_FLAG_PGPERR | FLASH_FLAG_PGSERR)
+
+/* Worst-case sector erase times in ms at x32, tERASE max of the STM32F429 datasheet */
+#define FLASHIF_ERASE_MAX_16K 500U
+#define FLASHIF_ERASE_MAX_64K 1100U
+#define FLASHIF_ERASE_MAX_128K 2000U
+
 /* Private macro -------------------------------------------------------------*/
 /* Private variables ---------------------------------------------------------*/
+extern uint32_t _sram_vector[]; /* RAM copy of the vector table, see the linker script */
+extern uint32_t _eram_vector[];
+
+static FlashIfJob aWriteQueue[FLASHIF_QUEUE_DEPTH];
+static uint32_t queueHead;
+static uint32_t queueCount;
+static uint32_t queueStatus = FLASHIF_OK;
+static uint32_t queueProgrammed;
+static uint32_t writeCursor;   /* Next address the queue will program */
+static uint32_t queueStart;    /* First address queued, start of the range FlashIfFlush() checks */
+static uint32_t queueCrc;      /* CRC-32 of everything queued */
+static uint64_t programCycles; /* Spent programming and checking */
+static uint32_t programBytes;
+
+/* Erase plan, see FlashIfErasePlan() */
+static volatile uint32_t eraseNext = USER_FLASH_END_ADDRESS + 1U; /* First address not known to be erased */
+static uint32_t eraseEnd = USER_FLASH_END_ADDRESS + 1U;           /* No erasing ahead from here on */
+static uint32_t eraseLimit = USER_FLASH_END_ADDRESS + 1U;         /* Nothing is erased or queued from here on */
+static volatile uint32_t eraseSector = FLASHIF_NO_SECTOR;         /* Sector erasing in the background */
+static volatile uint32_t eraseFailed;
+static uint32_t eraseSkipFrom = USER_FLASH_END_ADDRESS + 1U; /* Already erased by FlashIfEraseSlowSectors() */
+static uint32_t eraseSkipTo = USER_FLASH_END_ADDRESS + 1U;
+static uint32_t eraseStart;
+static uint32_t aEraseTime[FLASHIF_SECTOR_COUNT];
+
+/* Start address of each sector, followed by the end of the flash */
+static const uint32_t aSectorAddress[] = {
+    ADDR_FLASH_SECTOR_0,  ADDR_FLASH_SECTOR_1,  ADDR_FLASH_SECTOR_2,  ADDR_FLASH_SECTOR_3,  ADDR_FLASH_SECTOR_4,
+    ADDR_FLASH_SECTOR_5,  ADDR_FLASH_SECTOR_6,  ADDR_FLASH_SECTOR_7,  ADDR_FLASH_SECTOR_8,  ADDR_FLASH_SECTOR_9,
+    ADDR_FLASH_SECTOR_10, ADDR_FLASH_SECTOR_11, ADDR_FLASH_SECTOR_12, ADDR_FLASH_SECTOR_13, ADDR_FLASH_SECTOR_14,
+    ADDR_FLASH_SECTOR_15, ADDR_FLASH_SECTOR_16, ADDR_FLASH_SECTOR_17, ADDR_FLASH_SECTOR_18, ADDR_FLASH_SECTOR_19,
+    ADDR_FLASH_SECTOR_20, ADDR_FLASH_SECTOR_21, ADDR_FLASH_SECTOR_22, ADDR_FLASH_SECTOR_23, FLASH_END + 1U};
+
 /* Private function prototypes -----------------------------------------------*/
 static uint32_t GetSector(uint32_t address);
+static uint32_t FlashIfGetEraseTimeMax(uint32_t sector);
+static uint32_t FlashIfIsInBank(uint32_t address, uint32_t bank);
+static void FlashIfEraseNext(void);
+static uint32_t FlashIfProgram(uint32_t flashAddress, const uint32_t *data, uint32_t dataLength);
 
 /* Private functions ---------------------------------------------------------*/
 
@@ -47,28 +104,42 @@ void FlashIfInit(void)
 }
 
 /**
- * @brief  This function does an erase of all user flash area
- * @param  StartSector: start of user flash area
+ * @brief  This function does an erase of the user flash area from an address on
+ * @note   A sector that starts below StartAddress is kept, its part from
+ *         StartAddress on must already be erased.
+ * @param  StartAddress: first address to erase, APPLICATION_ADDRESS for all
  * @retval 0: user flash area successfully erased
  *         1: error occurred
  */
-uint32_t FlashIfErase(uint32_t startSector)
+uint32_t FlashIfErase(uint32_t startAddress)
 {
     uint32_t sectorError;
     FLASH_EraseInitTypeDef pEraseInit;
+    HAL_StatusTypeDef status;
 
     /* Unlock the Flash to enable the flash control register access *************/
     FlashIfInit();
 
     /* Get the sector where start the user flash area */
-    const uint32_t userStartSector = GetSector(APPLICATION_ADDRESS);
+    uint32_t userStartSector = GetSector(startAddress);
+    if (startAddress != aSectorAddress[userStartSector])
+    {
+        userStartSector++;
+    }
+    if (userStartSector >= 22U)
+    {
+        return (0);
+    }
 
     pEraseInit.TypeErase = TYPEERASE_SECTORS;
     pEraseInit.Sector = userStartSector;
     pEraseInit.NbSectors = 22 - userStartSector; /* Erase from start sector to sector 21 (preserve sector 22 and 23) */
     pEraseInit.VoltageRange = VOLTAGE_RANGE_3;
 
-    if (HAL_FLASHEx_Erase(&pEraseInit, &sectorError) != HAL_OK)
+    PROFILE_ENTER(PROFILE_SITE_ERASE);
+    status = HAL_FLASHEx_Erase(&pEraseInit, &sectorError);
+    PROFILE_LEAVE(PROFILE_SITE_ERASE);
+    if (status != HAL_OK)
     {
         /* Error occurred while page erase */
         return (1);
@@ -77,6 +148,198 @@ uint32_t FlashIfErase(uint32_t startSector)
     return (0);
 }
 
+/**
+ * @brief  Start the background erase of the first sector not yet erased
+ * @note   The flash cannot program while it erases, callers check that no
+ *         erase is running and that the queue is not programming.
+ * @param  None
+ * @retval None
+ */
+static void FlashIfEraseNext(void)
+{
+    FLASH_EraseInitTypeDef pEraseInit;
+
+    pEraseInit.TypeErase = TYPEERASE_SECTORS;
+    pEraseInit.Sector = GetSector(eraseNext);
+    pEraseInit.NbSectors = 1;
+    pEraseInit.VoltageRange = VOLTAGE_RANGE_3;
+
+    eraseStart = HAL_GetTick();
+    eraseSector = pEraseInit.Sector;
+    (void)HAL_FLASHEx_Erase_IT(&pEraseInit);
+}
+
+/**
+ * @brief  Start erasing the user flash area on demand from an address on
+ * @note   Nothing is erased here. FlashIfPoll() erases each sector in the
+ *         background: the sector the write cursor is about to enter while the
+ *         current one is still filling, or at the latest when a queued write
+ *         reaches it. Sectors from EndAddress on are only erased if a write
+ *         needs them. As with FlashIfErase(), a sector that starts below
+ *         StartAddress is kept and must already be erased from StartAddress on.
+ *         Sectors from LimitAddress on are never erased, and writes that
+ *         reach past it are refused by FlashIfQueueWrite().
+ * @param  StartAddress: first address to erase, APPLICATION_ADDRESS for all
+ * @param  EndAddress: end of the image
+ * @param  LimitAddress: end of the slot the image goes to
+ * @retval None
+ */
+void FlashIfErasePlan(uint32_t startAddress, uint32_t endAddress, uint32_t limitAddress)
+{
+    uint32_t i;
+
+    FlashIfInit();
+
+    if (startAddress < APPLICATION_ADDRESS)
+    {
+        startAddress = APPLICATION_ADDRESS;
+    }
+    eraseNext = (startAddress == FlashIfGetSectorStart(startAddress)) ? startAddress
+                                                                      : FlashIfGetSectorEnd(startAddress);
+    eraseLimit = (limitAddress > (USER_FLASH_END_ADDRESS + 1U)) ? (USER_FLASH_END_ADDRESS + 1U) : limitAddress;
+    eraseEnd = (endAddress > eraseLimit) ? eraseLimit : endAddress;
+    eraseFailed = 0;
+    eraseSkipFrom = USER_FLASH_END_ADDRESS + 1U;
+    eraseSkipTo = USER_FLASH_END_ADDRESS + 1U;
+    writeCursor = startAddress;
+
+    for (i = 0; i < FLASHIF_SECTOR_COUNT; i++)
+    {
+        aEraseTime[i] = 0;
+    }
+}
+
+/**
+ * @brief  Erase the sectors of the plan that lie below an address
+ * @note   Blocks until they are erased. For receivers that cannot pause the
+ *         sender while a sector is erased, as the flash does not program
+ *         meanwhile.
+ * @param  EndAddress: address after the last byte that must be erased
+ * @retval FLASHIF_OK, or FLASHIF_ERASEKO if a sector failed to erase
+ */
+uint32_t FlashIfEraseUpTo(uint32_t endAddress)
+{
+    if (endAddress > eraseLimit)
+    {
+        endAddress = eraseLimit;
+    }
+
+    PROFILE_ENTER(PROFILE_SITE_ERASE);
+    while (eraseFailed == 0U)
+    {
+        /* EraseNext only moves at the end of an erase, read it once none runs */
+        if (eraseSector == FLASHIF_NO_SECTOR)
+        {
+            if (eraseNext >= endAddress)
+            {
+                break;
+            }
+            FlashIfEraseNext();
+        }
+    }
+    PROFILE_LEAVE(PROFILE_SITE_ERASE);
+
+    return (eraseFailed == 0U) ? FLASHIF_OK : FLASHIF_ERASEKO;
+}
+
+/**
+ * @brief  Erase the sectors of the plan that are too slow to erase in the background
+ * @note   Blocks until they are erased. For receivers that cannot pause the
+ *         sender: nothing is programmed while a sector erases, so what arrives
+ *         meanwhile has to wait in the receive buffer. The plan is erased now
+ *         from the first sector whose worst-case erase time exceeds MaxStall
+ *         up to its end address; sectors only grow along a slot, so that is
+ *         the tail of the image. FlashIfPoll() erases the sectors before it in
+ *         the background and then skips the erased range.
+ * @param  MaxStall: longest erase in ms the receiver can wait out
+ * @retval FLASHIF_OK, or FLASHIF_ERASEKO if a sector failed to erase
+ */
+uint32_t FlashIfEraseSlowSectors(uint32_t maxStall)
+{
+    uint32_t next, first, status;
+
+    /* Let an erase started by FlashIfPoll() finish, it moves EraseNext */
+    while (eraseSector != FLASHIF_NO_SECTOR)
+    {
+    }
+
+    next = eraseNext;
+    first = next;
+    while ((first < eraseEnd) && (FlashIfGetEraseTimeMax(GetSector(first)) <= maxStall))
+    {
+        first = FlashIfGetSectorEnd(first);
+    }
+    if (first >= eraseEnd)
+    {
+        return FLASHIF_OK;
+    }
+
+    eraseNext = first;
+    status = FlashIfEraseUpTo(eraseEnd);
+    if (first != next)
+    {
+        eraseSkipFrom = first;
+        eraseSkipTo = eraseNext;
+        eraseNext = next;
+    }
+
+    return status;
+}
+
+/**
+ * @brief  Check whether a background erase is running
+ * @note   Flash programming stalls until it has finished.
+ * @param  None
+ * @retval 1 if erasing
+ */
+uint32_t FlashIfIsErasing(void)
+{
+    return (eraseSector != FLASHIF_NO_SECTOR) ? 1U : 0U;
+}
+
+/**
+ * @brief  Time the last planned erase of a sector took
+ * @param  Sector: sector number
+ * @retval Milliseconds, 0 if the sector was not erased since FlashIfErasePlan()
+ */
+uint32_t FlashIfGetEraseTime(uint32_t sector)
+{
+    return (sector < FLASHIF_SECTOR_COUNT) ? aEraseTime[sector] : 0U;
+}
+
+/**
+ * @brief  FLASH end of operation callback, a background sector erase is done
+ * @param  ReturnValue: erased sector, 0xFFFFFFFF once the request is complete
+ * @retval None
+ */
+void HAL_FLASH_EndOfOperationCallback(uint32_t ReturnValue)
+{
+    const uint32_t sector = eraseSector;
+
+    if ((ReturnValue == 0xFFFFFFFFU) && (sector != FLASHIF_NO_SECTOR))
+    {
+        aEraseTime[sector] = HAL_GetTick() - eraseStart;
+        eraseNext = (aSectorAddress[sector + 1U] == eraseSkipFrom) ? eraseSkipTo : aSectorAddress[sector + 1U];
+        eraseSector = FLASHIF_NO_SECTOR;
+    }
+}
+
+/**
+ * @brief  FLASH operation error callback, a background sector erase failed
+ * @param  ReturnValue: faulty sector
+ * @retval None
+ */
+void HAL_FLASH_OperationErrorCallback(uint32_t ReturnValue)
+{
+    UNUSED(ReturnValue);
+
+    if (eraseSector != FLASHIF_NO_SECTOR)
+    {
+        eraseFailed = 1;
+        eraseSector = FLASHIF_NO_SECTOR;
+    }
+}
+
 /**
  * @brief  This function writes a data buffer in flash (data are 32-bit aligned).
  * @note   After writing data buffer, the flash content is checked.
@@ -91,7 +354,8 @@ uint32_t FlashIfWrite(uint32_t flashAddress, uint32_t *data, uint32_t dataLength
 {
     uint32_t i = 0;
 
-    for (i = 0; (i < dataLength) && (flashAddress <= (USER_FLASH_END_ADDRESS - 4)); i++)
+    PROFILE_ENTER(PROFILE_SITE_WRITE);
+    for (i = 0; (i < dataLength) && (flashAddress <= (USER_FLASH_END_ADDRESS - 3U)); i++)
     {
         /* Device voltage range supposed to be [2.7V to 3.6V], the operation will
            be done by word */
@@ -101,6 +365,7 @@ uint32_t FlashIfWrite(uint32_t flashAddress, uint32_t *data, uint32_t dataLength
             if (*(uint32_t *)flashAddress != *(uint32_t *)(data + i))
             {
                 /* Flash content doesn't match SRAM content */
+                PROFILE_LEAVE(PROFILE_SITE_WRITE);
                 return (FLASHIF_WRITINGCTRL_ERROR);
             }
             /* Increment FLASH destination address */
@@ -109,13 +374,293 @@ uint32_t FlashIfWrite(uint32_t flashAddress, uint32_t *data, uint32_t dataLength
         else
         {
             /* Error occurred while writing data in Flash memory */
+            PROFILE_LEAVE(PROFILE_SITE_WRITE);
             return (FLASHIF_WRITING_ERROR);
         }
     }
+    PROFILE_LEAVE(PROFILE_SITE_WRITE);
 
     return (FLASHIF_OK);
 }
 
+/**
+ * @brief  Program a run of words with a single FMC setup
+ * @note   PG stays set for the whole run and only BSY is polled between
+ *         words, there is no HAL call and no read back per word. The sticky
+ *         error flags are checked once at the end; the data itself is checked
+ *         over the whole image by FlashIfFlush().
+ * @param  FlashAddress: start address for writing data buffer
+ * @param  Data: pointer on data buffer
+ * @param  DataLength: length of data buffer (unit is 32-bit word)
+ * @retval FLASHIF_OK, or FLASHIF_WRITING_ERROR if the FMC flagged an error
+ */
+static uint32_t FlashIfProgram(uint32_t flashAddress, const uint32_t *data, uint32_t dataLength)
+{
+    __IO uint32_t *destination = (__IO uint32_t *)flashAddress;
+    uint32_t i;
+
+    /* Same limit as FlashIfWrite(), the last word starts 3 bytes before the end */
+    if (flashAddress > (USER_FLASH_END_ADDRESS - 3U))
+    {
+        return (FLASHIF_OK);
+    }
+    if (dataLength > (((USER_FLASH_END_ADDRESS - 3U) - flashAddress) / 4U) + 1U)
+    {
+        dataLength = (((USER_FLASH_END_ADDRESS - 3U) - flashAddress) / 4U) + 1U;
+    }
+
+    while ((FLASH->SR & FLASH_SR_BSY) != 0U)
+    {
+    }
+    __HAL_FLASH_CLEAR_FLAG(FLASHIF_ERROR_FLAGS);
+
+    /* Device voltage range supposed to be [2.7V to 3.6V], program by word */
+    CLEAR_BIT(FLASH->CR, FLASH_CR_PSIZE);
+    SET_BIT(FLASH->CR, FLASH_PSIZE_WORD | FLASH_CR_PG);
+    for (i = 0; i < dataLength; i++)
+    {
+        destination[i] = data[i];
+        while ((FLASH->SR & FLASH_SR_BSY) != 0U)
+        {
+        }
+    }
+    CLEAR_BIT(FLASH->CR, FLASH_CR_PG);
+
+    return ((FLASH->SR & FLASHIF_ERROR_FLAGS) != 0U) ? FLASHIF_WRITING_ERROR : FLASHIF_OK;
+}
+
+/**
+ * @brief  Empty the write queue and clear its error status.
+ * @param  None
+ * @retval None
+ */
+void FlashIfQueueInit(void)
+{
+    queueHead = 0;
+    queueCount = 0;
+    queueStatus = FLASHIF_OK;
+    queueProgrammed = 0;
+    queueStart = 0;
+    queueCrc = 0;
+    programCycles = 0;
+    programBytes = 0;
+
+    /* Programming time is measured with the cycle counter */
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    /* No erasing until a plan is set up, let an erase still running finish */
+    while (eraseSector != FLASHIF_NO_SECTOR)
+    {
+    }
+    eraseNext = USER_FLASH_END_ADDRESS + 1U;
+    eraseEnd = USER_FLASH_END_ADDRESS + 1U;
+    eraseLimit = USER_FLASH_END_ADDRESS + 1U;
+    eraseFailed = 0;
+    eraseSkipFrom = USER_FLASH_END_ADDRESS + 1U;
+    eraseSkipTo = USER_FLASH_END_ADDRESS + 1U;
+}
+
+/**
+ * @brief  Queue a data buffer for programming (data are 32-bit aligned).
+ * @note   The buffer must stay untouched until the queue has drained past it.
+ *         If the queue is full this call programs until a slot is free.
+ *         Writes must follow each other in the flash, FlashIfFlush() checks
+ *         them as one range. A write past the limit of the erase plan is
+ *         refused and fails the queue.
+ * @param  FlashAddress: start address for writing data buffer
+ * @param  Data: pointer on data buffer
+ * @param  DataLength: length of data buffer (unit is 32-bit word)
+ * @retval FLASHIF_OK if queued, otherwise the error of an earlier write
+ */
+uint32_t FlashIfQueueWrite(uint32_t flashAddress, uint32_t *data, uint32_t dataLength)
+{
+    if ((flashAddress < APPLICATION_ADDRESS) || (flashAddress > eraseLimit) ||
+        (dataLength > ((eraseLimit - flashAddress) / 4U)))
+    {
+        queueStatus = FLASHIF_WRITING_ERROR;
+    }
+
+    while ((queueCount == FLASHIF_QUEUE_DEPTH) && (queueStatus == FLASHIF_OK))
+    {
+        (void)FlashIfPoll();
+    }
+
+    if (queueStatus == FLASHIF_OK)
+    {
+        FlashIfJob *job = &aWriteQueue[(queueHead + queueCount) % FLASHIF_QUEUE_DEPTH];
+
+        job->address = flashAddress;
+        job->data = data;
+        job->length = dataLength;
+        queueCount++;
+
+        if (queueStart == 0U)
+        {
+            queueStart = flashAddress;
+        }
+        queueCrc = Crc32Update(queueCrc, (const uint8_t *)data, dataLength * 4U);
+    }
+
+    return queueStatus;
+}
+
+/**
+ * @brief  Program the next slice of the oldest queued buffer.
+ * @note   Call whenever there is idle time, e.g. while waiting for UART data.
+ *         Also drives the background erase of the plan set by
+ *         FlashIfErasePlan(): nothing is programmed while a sector erases.
+ * @param  None
+ * @retval FLASHIF_OK, or the sticky error of a failed queued write
+ */
+uint32_t FlashIfPoll(void)
+{
+    if (eraseFailed != 0U)
+    {
+        queueStatus = FLASHIF_ERASEKO;
+    }
+    if ((eraseSector != FLASHIF_NO_SECTOR) || (queueStatus != FLASHIF_OK))
+    {
+        return queueStatus;
+    }
+
+    if (queueCount > 0U)
+    {
+        FlashIfJob *job = &aWriteQueue[queueHead];
+        const uint32_t words = (job->length < FLASHIF_PROGRAM_SLICE) ? job->length : FLASHIF_PROGRAM_SLICE;
+
+        if (((job->address + (words * 4U)) > eraseNext) && (eraseNext < eraseLimit))
+        {
+            /* The write reached a sector that is not erased yet */
+            FlashIfEraseNext();
+            return queueStatus;
+        }
+
+        const uint32_t cycles = DWT->CYCCNT;
+
+        PROFILE_ENTER(PROFILE_SITE_PROGRAM);
+        queueStatus = FlashIfProgram(job->address, job->data, words);
+        PROFILE_LEAVE(PROFILE_SITE_PROGRAM);
+        programCycles += DWT->CYCCNT - cycles;
+        programBytes += words * 4U;
+        job->address += words * 4U;
+        writeCursor = job->address;
+        job->data += words;
+        job->length -= words;
+
+        if ((job->length == 0U) || (queueStatus != FLASHIF_OK))
+        {
+            if (queueStatus == FLASHIF_OK)
+            {
+                queueProgrammed = job->address;
+            }
+            queueHead = (queueHead + 1U) % FLASHIF_QUEUE_DEPTH;
+            queueCount--;
+        }
+    }
+    else if ((eraseNext < eraseEnd) && (writeCursor >= FlashIfGetSectorStart(eraseNext - 1U)) &&
+             (FlashIfIsReadWhileWriteSafe(eraseNext) != 0U))
+    {
+        /* The write cursor is in the last erased sector, erase the next one
+           while its data is still on the line. Not if that would stall the
+           CPU, then it waits until a write needs it. */
+        FlashIfEraseNext();
+    }
+
+    return queueStatus;
+}
+
+/**
+ * @brief  Program everything still queued, then check what was programmed.
+ * @note   The flash range from the first queued write on is read back in one
+ *         pass and its CRC-32 compared with that of the queued data.
+ * @param  None
+ * @retval FLASHIF_OK if all queued writes succeeded, FLASHIF_WRITINGCTRL_ERROR
+ *         if the flash content differs from the queued data
+ */
+uint32_t FlashIfFlush(void)
+{
+    while ((queueCount > 0U) && (queueStatus == FLASHIF_OK))
+    {
+        (void)FlashIfPoll();
+    }
+
+    if ((queueStatus == FLASHIF_OK) && (queueProgrammed != 0U))
+    {
+        const uint32_t cycles = DWT->CYCCNT;
+
+        /* Lines read before they were programmed may still be cached */
+        if (READ_BIT(FLASH->ACR, FLASH_ACR_DCEN) != 0U)
+        {
+            __HAL_FLASH_DATA_CACHE_DISABLE();
+            __HAL_FLASH_DATA_CACHE_RESET();
+            __HAL_FLASH_DATA_CACHE_ENABLE();
+        }
+        if (Crc32Update(0, (const uint8_t *)queueStart, queueProgrammed - queueStart) != queueCrc)
+        {
+            /* Flash content doesn't match SRAM content */
+            queueStatus = FLASHIF_WRITINGCTRL_ERROR;
+        }
+        programCycles += DWT->CYCCNT - cycles;
+    }
+
+    return queueStatus;
+}
+
+/**
+ * @brief  Cost of programming since FlashIfQueueInit()
+ * @note   Includes the check done by FlashIfFlush().
+ * @param  None
+ * @retval CPU cycles per KB programmed, 0 if nothing was programmed
+ */
+uint32_t FlashIfGetProgramCycles(void)
+{
+    return (programBytes != 0U) ? (uint32_t)((programCycles * 1024U) / programBytes) : 0U;
+}
+
+/**
+ * @brief  Time spent programming since FlashIfQueueInit()
+ * @note   Includes the check done by FlashIfFlush().
+ * @param  None
+ * @retval Milliseconds
+ */
+uint32_t FlashIfGetProgramTime(void)
+{
+    return (uint32_t)(programCycles / (SystemCoreClock / 1000U));
+}
+
+/**
+ * @brief  End of the last queued write that has completed
+ * @note   Queued writes complete in order, so for a sequential image this is
+ *         the end of the contiguous programmed part.
+ * @param  None
+ * @retval Flash address, 0 if nothing was programmed since FlashIfQueueInit()
+ */
+uint32_t FlashIfGetProgrammed(void)
+{
+    return queueProgrammed;
+}
+
+/**
+ * @brief  Start address of the sector holding an address
+ * @param  address: Flash address
+ * @retval Sector start address
+ */
+uint32_t FlashIfGetSectorStart(uint32_t address)
+{
+    return aSectorAddress[GetSector(address)];
+}
+
+/**
+ * @brief  End of the sector holding an address
+ * @param  address: Flash address
+ * @retval Start address of the next sector
+ */
+uint32_t FlashIfGetSectorEnd(uint32_t address)
+{
+    return aSectorAddress[GetSector(address) + 1U];
+}
+
 /**
  * @brief  Returns the write protection status of user flash area.
  * @param  None
@@ -153,6 +698,88 @@ uint16_t FlashIfGetWriteProtectionStatus(void)
     }
 }
 
+/**
+ * @brief  Move the vector table to RAM
+ * @note   Vectors are fetched from Flash bank 1 otherwise, which stalls every
+ *         interrupt while a bank 1 sector is erased or programmed. The handlers
+ *         and the code they call are in the .ramcode section.
+ * @param  None
+ * @retval None
+ */
+void FlashIfRelocateVectors(void)
+{
+    const uint32_t *source = (const uint32_t *)SCB->VTOR;
+    uint32_t i;
+
+    if (SCB->VTOR == (uint32_t)_sram_vector)
+    {
+        return;
+    }
+
+    __disable_irq();
+    for (i = 0; i < (uint32_t)(_eram_vector - _sram_vector); i++)
+    {
+        _sram_vector[i] = source[i];
+    }
+    SCB->VTOR = (uint32_t)_sram_vector;
+    __DSB();
+    __enable_irq();
+}
+
+/**
+ * @brief  Flash bank holding an address
+ * @param  address: Flash address
+ * @retval 1 for sectors 0 to 11, 2 for sectors 12 to 23
+ */
+uint32_t FlashIfGetBank(uint32_t address)
+{
+    return (address >= ADDR_FLASH_SECTOR_12) ? 2U : 1U;
+}
+
+/**
+ * @brief  Check whether an address lies in a Flash bank
+ * @param  address: any address
+ * @param  bank: 1 or 2
+ * @retval 1 if it does
+ */
+static uint32_t FlashIfIsInBank(uint32_t address, uint32_t bank)
+{
+    return ((address >= FLASH_BASE) && (address <= FLASH_END) && (FlashIfGetBank(address) == bank)) ? 1U : 0U;
+}
+
+/**
+ * @brief  Check whether erasing or programming an address keeps the CPU running
+ * @note   The CPU stalls on a fetch from the bank being written. Safe when the
+ *         driver and the vector table are in RAM (.ramcode and
+ *         FlashIfRelocateVectors()) or in the other bank.
+ * @param  address: Flash address to be erased or programmed
+ * @retval 1 if reading can go on while writing
+ */
+uint32_t FlashIfIsReadWhileWriteSafe(uint32_t address)
+{
+    const uint32_t bank = FlashIfGetBank(address);
+
+    return ((FlashIfIsInBank((uint32_t)&FlashIfPoll, bank) == 0U) && (FlashIfIsInBank(SCB->VTOR, bank) == 0U)) ? 1U
+                                                                                                               : 0U;
+}
+
+/**
+ * @brief  Worst-case erase time of a sector
+ * @param  Sector: sector number
+ * @retval Milliseconds
+ */
+static uint32_t FlashIfGetEraseTimeMax(uint32_t sector)
+{
+    const uint32_t size = aSectorAddress[sector + 1U] - aSectorAddress[sector];
+
+    if (size <= 0x4000U)
+    {
+        return FLASHIF_ERASE_MAX_16K;
+    }
+
+    return (size <= 0x10000U) ? FLASHIF_ERASE_MAX_64K : FLASHIF_ERASE_MAX_128K;
+}
+
 /**
  * @brief  Gets the sector of a given address for GD32F4xx (2MB Flash)
  * @param  address: Flash address
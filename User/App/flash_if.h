@@ -77,6 +77,17 @@ enum
    Note: the 1st two sectors 0x08000000-0x08007FFF are reserved for the IAP code */
 #define APPLICATION_ADDRESS (uint32_t)0x08008000
 
+/* Number of packet writes that can wait in the queue while the next packet
+   is being received. The packet receiver needs one more buffer than this. */
+#define FLASHIF_QUEUE_DEPTH ((uint32_t)2)
+/* Words programmed per FlashIfPoll() call, bounds the time spent away from
+   the receive loop */
+#define FLASHIF_PROGRAM_SLICE ((uint32_t)64)
+
+/* Number of Flash sectors, and the value of "no sector" */
+#define FLASHIF_SECTOR_COUNT ((uint32_t)24)
+#define FLASHIF_NO_SECTOR ((uint32_t)0xFFFFFFFF)
+
 /* Define bitmap representing user flash area that could be write protected for GD32F4xx */
 #define FLASH_SECTOR_TO_BE_PROTECTED                                                                                   \
     (OB_WRP_SECTOR_2 | OB_WRP_SECTOR_3 | OB_WRP_SECTOR_4 | OB_WRP_SECTOR_5 | OB_WRP_SECTOR_6 | OB_WRP_SECTOR_7 |       \
@@ -85,8 +96,25 @@ enum
 /* Exported macro ------------------------------------------------------------*/
 /* Exported functions ------------------------------------------------------- */
 void FlashIfInit(void);
-uint32_t FlashIfErase(uint32_t StartSector);
+uint32_t FlashIfErase(uint32_t StartAddress);
+void FlashIfErasePlan(uint32_t StartAddress, uint32_t EndAddress, uint32_t LimitAddress);
+uint32_t FlashIfEraseUpTo(uint32_t EndAddress);
+uint32_t FlashIfEraseSlowSectors(uint32_t MaxStall);
+uint32_t FlashIfIsErasing(void);
+uint32_t FlashIfGetEraseTime(uint32_t Sector);
 uint32_t FlashIfWrite(uint32_t FlashAddress, uint32_t *Data, uint32_t DataLength);
+void FlashIfQueueInit(void);
+uint32_t FlashIfQueueWrite(uint32_t FlashAddress, uint32_t *Data, uint32_t DataLength);
+uint32_t FlashIfPoll(void);
+uint32_t FlashIfFlush(void);
+uint32_t FlashIfGetProgrammed(void);
+uint32_t FlashIfGetProgramCycles(void);
+uint32_t FlashIfGetProgramTime(void);
+uint32_t FlashIfGetSectorStart(uint32_t address);
+uint32_t FlashIfGetSectorEnd(uint32_t address);
+uint32_t FlashIfGetBank(uint32_t address);
+uint32_t FlashIfIsReadWhileWriteSafe(uint32_t address);
+void FlashIfRelocateVectors(void);
 uint16_t FlashIfGetWriteProtectionStatus(void);
 HAL_StatusTypeDef FlashIfWriteProtectionConfig(uint32_t modifier);
 
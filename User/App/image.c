@@ -0,0 +1,96 @@
+/* USER CODE BEGIN Header */
+/**
+ ******************************************************************************
+ * @file           : image.c
+ * @brief          : Firmware image header and trailer checks
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2025 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+/* USER CODE END Header */
+
+/* Includes ------------------------------------------------------------------*/
+#include "image.h"
+#include "crc32.h"
+#include "crc32_hw.h"
+
+#include <stddef.h>
+
+/* Private define ------------------------------------------------------------*/
+#define IMAGE_ALIGN4(x) (((x) + 3U) & ~3U)
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief  Find a valid image header
+ * @param  address: start of the slot
+ * @retval Header, or NULL if the slot does not start with an intact header
+ *         describing an application right behind it
+ */
+const ImageHeader *ImageGetHeader(uint32_t address)
+{
+    const ImageHeader *header = (const ImageHeader *)address;
+
+    if ((header->Magic != IMAGE_MAGIC) || (header->HeaderVersion != IMAGE_HEADER_VERSION) ||
+        (header->HeaderSize != IMAGE_HEADER_SIZE) ||
+        (header->HeaderCrc != Crc32Update(0, (const uint8_t *)header, offsetof(ImageHeader, HeaderCrc))))
+    {
+        return NULL;
+    }
+
+    /* Linked for this slot, and the reset handler inside the application */
+    if ((header->LoadAddress != (address + IMAGE_HEADER_SIZE)) || (header->EntryPoint < header->LoadAddress) ||
+        ((header->EntryPoint - header->LoadAddress) >= header->Length))
+    {
+        return NULL;
+    }
+
+    return header;
+}
+
+/**
+ * @brief  Check that a whole image was written, without reading it
+ * @param  address: start of the slot
+ * @param  size: size of the slot
+ * @retval 1 if the header is valid, the image fits the slot and its trailer
+ *         is in place
+ */
+uint32_t ImageIsComplete(uint32_t address, uint32_t size)
+{
+    const ImageHeader *header = ImageGetHeader(address);
+    const ImageTrailer *trailer;
+
+    if ((header == NULL) || (header->Length > (size - IMAGE_HEADER_SIZE - sizeof(ImageTrailer))))
+    {
+        return 0;
+    }
+
+    trailer = (const ImageTrailer *)(header->LoadAddress + IMAGE_ALIGN4(header->Length));
+
+    return ((trailer->Magic == IMAGE_TRAILER_MAGIC) && (trailer->Length == header->Length) &&
+            (trailer->Crc == header->Crc) && (trailer->Check == ~header->HeaderCrc))
+               ? 1U
+               : 0U;
+}
+
+/**
+ * @brief  Check every byte of an image with the CRC unit
+ * @note   Runs the header, the application and the trailer through the CRC
+ *         unit by DMA. The trailer's HwCrc word brings the result to 0.
+ * @param  header: header from ImageGetHeader()
+ * @retval 1 if the image is intact
+ */
+uint32_t ImageVerify(const ImageHeader *header)
+{
+    const uint32_t bytes = IMAGE_HEADER_SIZE + IMAGE_ALIGN4(header->Length) + sizeof(ImageTrailer);
+
+    return (Crc32HwCompute((uint32_t)header, bytes / 4U) == 0U) ? 1U : 0U;
+}
@@ -0,0 +1,88 @@
+/* USER CODE BEGIN Header */
+/**
+ ******************************************************************************
+ * @file           : image.h
+ * @brief          : Firmware image header and trailer
+ *
+ *          Scripts/image_pack.py turns an application binary into:
+ *
+ *            slot + 0x000  ImageHeader, padded with 0xFF to IMAGE_HEADER_SIZE
+ *            slot + 0x200  application, linked for this address
+ *            ...           ImageTrailer, word aligned after the application
+ *
+ *          The header describes the image and is protected by its own CRC.
+ *          The trailer is the last thing written, so finding it intact means
+ *          the whole image made it to Flash. Both are checked in constant
+ *          time. The last trailer word is chosen so that the CRC unit reads 0
+ *          over the whole image, which lets ImageVerify() check every byte
+ *          with DMA and no expected value.
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2025 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+/* USER CODE END Header */
+
+#ifndef __IMAGE_H__
+#define __IMAGE_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+// 镜像格式，需与 Scripts/image_pack.py 保持一致
+#define IMAGE_MAGIC ((uint32_t)0x474D4942)         /* "BIMG" */
+#define IMAGE_TRAILER_MAGIC ((uint32_t)0x444E4542) /* "BEND" */
+#define IMAGE_HEADER_VERSION ((uint32_t)2)
+/* Room taken by the header, keeps the vector table aligned for VTOR */
+#define IMAGE_HEADER_SIZE ((uint32_t)0x200)
+
+/* ImageHeader.Flags */
+#define IMAGE_FLAG_KEEP_CLOCKS ((uint32_t)0x01) /* Start with the bootloader's PLL, see boot_handoff.h */
+
+    /* Exported types ------------------------------------------------------------*/
+    typedef struct
+    {
+        uint32_t Magic;         /* IMAGE_MAGIC */
+        uint32_t HeaderVersion; /* IMAGE_HEADER_VERSION */
+        uint32_t HeaderSize;    /* Offset of the application, IMAGE_HEADER_SIZE */
+        uint32_t Flags;         /* IMAGE_FLAG_xxx */
+        uint32_t Version;       /* Application version, major << 24 | minor << 16 | patch */
+        uint32_t Length;        /* Application bytes */
+        uint32_t LoadAddress;   /* Address the application is linked for, its vector table */
+        uint32_t EntryPoint;    /* Reset handler */
+        uint32_t Crc;           /* CRC-32 of the application */
+        uint32_t HeaderCrc;     /* CRC-32 of the fields above */
+    } ImageHeader;
+
+    typedef struct
+    {
+        uint32_t Magic;  /* IMAGE_TRAILER_MAGIC */
+        uint32_t Length; /* Copy of ImageHeader.Length */
+        uint32_t Crc;    /* Copy of ImageHeader.Crc */
+        uint32_t Check;  /* ~ImageHeader.HeaderCrc, ties the trailer to its header */
+        uint32_t HwCrc;  /* CRC32_HW_POLY remainder of everything before it */
+    } ImageTrailer;
+
+    /* Exported functions ------------------------------------------------------- */
+    const ImageHeader *ImageGetHeader(uint32_t address);
+    uint32_t ImageIsComplete(uint32_t address, uint32_t size);
+    uint32_t ImageVerify(const ImageHeader *header);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __IMAGE_H__ */
@@ -0,0 +1,122 @@
+/* USER CODE BEGIN Header */
+/**
+ ******************************************************************************
+ * @file           : log.c
+ * @brief          : Diagnostic output drained by DMA, apart from the data link
+ *
+ *          printf() ends up in LogWrite(), which copies into a ring and
+ *          returns. The DMA sends the ring on LOG_UART (UART4) one contiguous
+ *          piece at a time, the transmit complete interrupt starts the next.
+ *          Nothing waits for the line: bytes that do not fit are dropped and
+ *          counted in logDropped, and output written before the UART is
+ *          initialised goes out with the first write after it.
+ *
+ *          The data link on DEBUG_UART is not touched, so diagnostics can no
+ *          longer stall a transfer or leave RS485 driving the bus.
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2025 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+/* USER CODE END Header */
+
+/* Includes ------------------------------------------------------------------*/
+#include "log.h"
+#include "usart.h"
+
+/* Private function prototypes -----------------------------------------------*/
+static void LogKick(void);
+
+/* Private variables ---------------------------------------------------------*/
+static uint8_t aLogBuffer[LOG_BUFFER_SIZE];
+static volatile uint32_t logHead;    /* Bytes written, free running */
+static volatile uint32_t logTail;    /* Bytes sent, free running */
+static volatile uint32_t logSending; /* Bytes handed to the DMA, 0 if idle */
+static volatile uint32_t logDropped; /* Bytes that did not fit */
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Hand the oldest waiting bytes to the DMA unless it is busy
+ * @note   Called from the writer and from the transmit complete interrupt.
+ * @retval None
+ */
+static void LogKick(void)
+{
+    const uint32_t primask = __get_PRIMASK();
+    uint32_t tail, count;
+
+    __disable_irq();
+
+    /* The HAL aborted the transfer on an error, send the piece again */
+    if ((logSending != 0U) && (LOG_UART.gState == HAL_UART_STATE_READY))
+    {
+        logSending = 0;
+    }
+
+    tail = logTail;
+    count = logHead - tail;
+    if ((logSending == 0U) && (count != 0U))
+    {
+        /* Up to the end of the ring, the rest goes when this piece is done */
+        if (count > (LOG_BUFFER_SIZE - (tail & (LOG_BUFFER_SIZE - 1U))))
+        {
+            count = LOG_BUFFER_SIZE - (tail & (LOG_BUFFER_SIZE - 1U));
+        }
+
+        logSending = count;
+        if (HAL_UART_Transmit_DMA(&LOG_UART, &aLogBuffer[tail & (LOG_BUFFER_SIZE - 1U)], (uint16_t)count) != HAL_OK)
+        {
+            /* Not initialised yet or shut down for the jump, the bytes wait */
+            logSending = 0;
+        }
+    }
+
+    __set_PRIMASK(primask);
+}
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief  Queue bytes for the log UART
+ * @note   Never waits. Not reentrant, call from the main loop only.
+ * @param  data: bytes
+ * @param  size: number of bytes
+ * @retval None
+ */
+void LogWrite(const uint8_t *data, uint32_t size)
+{
+    const uint32_t head = logHead;
+    uint32_t i;
+
+    for (i = 0; (i < size) && ((head + i - logTail) < LOG_BUFFER_SIZE); i++)
+    {
+        aLogBuffer[(head + i) & (LOG_BUFFER_SIZE - 1U)] = data[i];
+    }
+    logDropped += size - i;
+    logHead = head + i;
+
+    LogKick();
+}
+
+/**
+ * @brief  Tx transfer completed callback, the DMA has sent a piece of the ring
+ * @param  huart: UART handle
+ * @retval None
+ */
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+    if (huart == &LOG_UART)
+    {
+        logTail += logSending;
+        logSending = 0;
+        LogKick();
+    }
+}
@@ -28,42 +28,247 @@
 
 /* Includes ------------------------------------------------------------------*/
 #include "menu.h"
+#include "boot_handoff.h"
+#include "boot_main.h"
 #include "common.h"
+#include "profile.h"
+#include "serial_rx.h"
+#include "slot.h"
+#include "store.h"
+#include "telemetry.h"
 #include "ymodem.h"
+#include "zmodem.h"
 
 /* Private typedef -----------------------------------------------------------*/
+typedef COM_StatusTypeDef (*pReceiveFunction)(uint32_t *size);
+
 /* Private define ------------------------------------------------------------*/
+/* Time given to pick ZMODEM before the YMODEM receiver starts */
+#define MENU_SELECT_TIMEOUT ((uint32_t)2000)
+/* Transfer records listed by 't', latest first */
+#define MENU_TELEMETRY_SHOWN ((uint32_t)8)
+
 /* Private macro -------------------------------------------------------------*/
 /* Private variables ---------------------------------------------------------*/
 uint8_t aFileName[FILE_NAME_LENGTH];
 
 /* Private function prototypes -----------------------------------------------*/
-void SerialDownload(void);
+void SerialDownload(pReceiveFunction receive);
+static void SerialShowEraseTimes(void);
+static void SerialShowSlot(uint32_t slot);
+static void SerialRollback(void);
+static void SerialPutValue(const char *label, uint32_t value);
+static void SerialShowTelemetry(void);
 
 /* Private functions ---------------------------------------------------------*/
 
 /**
- * @brief  Download a file via serial port
+ * @brief  Print how long each sector erased during the download took
+ * @param  None
+ * @retval None
+ */
+static void SerialShowEraseTimes(void)
+{
+    uint8_t number[11] = {0};
+    uint32_t sector, time;
+
+    for (sector = 0; sector < FLASHIF_SECTOR_COUNT; sector++)
+    {
+        time = FlashIfGetEraseTime(sector);
+        if (time != 0U)
+        {
+            SerialPutString((uint8_t *)" Erase sector ");
+            Int2Str(number, sector);
+            SerialPutString(number);
+            SerialPutString((uint8_t *)": ");
+            Int2Str(number, time);
+            SerialPutString(number);
+            SerialPutString((uint8_t *)" ms\r\n");
+        }
+    }
+}
+
+/**
+ * @brief  Print a slot name and its link address
+ * @param  slot: SLOT_A or SLOT_B
+ * @retval None
+ */
+static void SerialShowSlot(uint32_t slot)
+{
+    if (slot == SLOT_B)
+    {
+        SerialPutString((uint8_t *)"slot B (0x08100000)");
+    }
+    else
+    {
+        SerialPutString((uint8_t *)"slot A (0x08008000)");
+    }
+}
+
+/**
+ * @brief  Boot the image in the inactive slot again
+ * @param  None
+ * @retval None
+ */
+static void SerialRollback(void)
+{
+    const uint32_t slot = SlotGetTarget();
+    const uint32_t result = SlotRollback();
+
+    if (result == SLOT_OK)
+    {
+        (void)StoreIncrement(STORE_KEY_ROLLBACKS);
+        SerialPutString((uint8_t *)"\r\nRolled back to ");
+        SerialShowSlot(slot);
+        SerialPutString((uint8_t *)"\r\n");
+    }
+    else if (result == SLOT_NOT_BOOTABLE)
+    {
+        SerialShowSlot(slot);
+        SerialPutString((uint8_t *)" holds no complete image, nothing to roll back to\r\n");
+    }
+    else
+    {
+        SerialPutString((uint8_t *)"\r\nFailed to record the active slot!\r\n");
+    }
+}
+
+/**
+ * @brief  Print a label followed by a decimal number
+ * @param  label: text before the number
+ * @param  value: number
+ * @retval None
+ */
+static void SerialPutValue(const char *label, uint32_t value)
+{
+    uint8_t number[11] = {0};
+
+    Int2Str(number, value);
+    SerialPutString((uint8_t *)label);
+    SerialPutString(number);
+}
+
+/**
+ * @brief  Print the records of the last download sessions
  * @param  None
  * @retval None
  */
-void SerialDownload(void)
+static void SerialShowTelemetry(void)
+{
+    const TelemetryRecord *record;
+    uint32_t index;
+
+    SerialPutValue("\r\nTransfers recorded: ", TelemetryGetCount());
+    SerialPutString((uint8_t *)"\r\n");
+
+    for (index = 0; index < MENU_TELEMETRY_SHOWN; index++)
+    {
+        record = TelemetryGet(index);
+        if (record == NULL)
+        {
+            break;
+        }
+
+        SerialPutValue(" #", record->Sequence);
+        SerialPutValue(": status ", record->Status);
+        SerialPutValue(", ", record->Size);
+        SerialPutValue(" Bytes in ", record->Time);
+        SerialPutValue(" ms, ", (record->Time != 0U) ? ((record->Size * 1000U) / record->Time) : 0U);
+        SerialPutValue(" B/s at ", record->Baud * 100U);
+        SerialPutString((uint8_t *)" baud");
+        if ((record->Flags & TELEMETRY_FLAG_STREAMING) != 0U)
+        {
+            SerialPutString((uint8_t *)", YMODEM-G");
+        }
+        if ((record->Flags & TELEMETRY_FLAG_XBLOCK) != 0U)
+        {
+            SerialPutString((uint8_t *)", 4K/8K blocks");
+        }
+        if ((record->Flags & TELEMETRY_FLAG_RESUMED) != 0U)
+        {
+            SerialPutString((uint8_t *)", resumed");
+        }
+        if ((record->Flags & TELEMETRY_FLAG_OVERRUN) != 0U)
+        {
+            SerialPutString((uint8_t *)", overrun");
+        }
+        SerialPutValue("\r\n   NAK ", record->Naks);
+        SerialPutValue(", timeout ", record->Timeouts);
+        SerialPutValue(", CRC ", record->CrcErrors);
+        SerialPutValue(", sequence ", record->SequenceErrors);
+        SerialPutValue(", erase ", record->EraseTime);
+        SerialPutValue(" ms, program ", record->ProgramTime);
+        SerialPutString((uint8_t *)" ms\r\n");
+    }
+}
+
+/**
+ * @brief  Download a file via serial port
+ * @param  receive: protocol receiver, Ymodem_Receive or Zmodem_Receive
+ * @retval None
+ */
+void SerialDownload(pReceiveFunction receive)
 {
     uint8_t number[11] = {0};
     uint32_t size = 0;
+    uint32_t slotResult = SLOT_OK;
+    uint32_t cold;
+    uint32_t start;
     COM_StatusTypeDef result;
 
     SerialPutString((uint8_t *)"Waiting for the file to be sent ... (press 'a' to abort)\n\r");
-    result = Ymodem_Receive(&size);
+    PROFILE_RESET();
+    start = HAL_GetTick();
+    result = receive(&size);
+
+    /* Boot the new image from now on, the previous one stays in the other slot */
     if (result == COM_OK)
+    {
+        slotResult = SlotActivate(SlotGetTarget(), size);
+        if (slotResult == SLOT_OK)
+        {
+            (void)StoreIncrement(STORE_KEY_UPDATES);
+        }
+    }
+
+    /* Reported to the application on its next start */
+    BootHandoffRecordTransfer(((result == COM_OK) && (slotResult != SLOT_OK)) ? COM_ERROR : result, size,
+                              HAL_GetTick() - start);
+
+    if ((result == COM_OK) && (slotResult == SLOT_NOT_BOOTABLE))
+    {
+        SerialPutString((uint8_t *)"\n\n\rThe image is incomplete, corrupt or not linked for ");
+        SerialShowSlot(SlotGetTarget());
+        SerialPutString((uint8_t *)", the active slot is unchanged.\n\r");
+    }
+    else if ((result == COM_OK) && (slotResult != SLOT_OK))
+    {
+        SerialPutString((uint8_t *)"\n\n\rFailed to record the active slot!\n\r");
+    }
+    else if (result == COM_OK)
     {
         SerialPutString(
             (uint8_t *)"\n\n\r Programming Completed Successfully!\n\r--------------------------------\r\n Name: ");
         SerialPutString(aFileName);
+        SerialPutString((uint8_t *)"\n\r Slot: ");
+        SerialShowSlot(SlotGetActive());
         Int2Str(number, size);
         SerialPutString((uint8_t *)"\n\r Size: ");
         SerialPutString(number);
         SerialPutString((uint8_t *)" Bytes\r\n");
+        SerialShowEraseTimes();
+        Int2Str(number, FlashIfGetProgramCycles());
+        SerialPutString((uint8_t *)" Program: ");
+        SerialPutString(number);
+        SerialPutString((uint8_t *)" cycles/KB\r\n");
+        Int2Str(number, SlotGetVerifyTime(&cold));
+        SerialPutString((uint8_t *)" Verify: ");
+        SerialPutString(number);
+        SerialPutString((uint8_t *)" us\r\n");
+        Int2Str(number, StoreGet(STORE_KEY_UPDATES, 0));
+        SerialPutString((uint8_t *)" Updates: ");
+        SerialPutString(number);
+        SerialPutString((uint8_t *)"\r\n");
         SerialPutString((uint8_t *)"-------------------\n");
     }
     else if (result == COM_LIMIT)
@@ -82,6 +287,9 @@ void SerialDownload(void)
     {
         SerialPutString((uint8_t *)"\n\rFailed to receive the file!\n\r");
     }
+
+    /* Where the time of this session went */
+    PROFILE_DUMP();
 }
 
 /**
@@ -91,6 +299,12 @@ void SerialDownload(void)
  */
 void Main_Menu(void)
 {
+    uint8_t number[11] = {0};
+    uint8_t key = 0;
+#if (BOOT_KEEP_CLOCKS != 0)
+    uint32_t slot;
+#endif
+
     SerialPutString((uint8_t *)"\r\n======================================================================");
     SerialPutString((uint8_t *)"\r\n=                          GD32F4xx Bootloader                      =");
     SerialPutString((uint8_t *)"\r\n=                                                                    =");
@@ -99,16 +313,69 @@ void Main_Menu(void)
     SerialPutString((uint8_t *)"\r\n======================================================================");
     SerialPutString((uint8_t *)"\r\n\r\n");
 
+    Int2Str(number, BootGetTime());
+    SerialPutString((uint8_t *)"Started in ");
+    SerialPutString(number);
+    SerialPutString((uint8_t *)" us\r\n");
+
     SerialPutString((uint8_t *)"Ready for firmware download via YMODEM protocol...\r\n");
+    SerialPutString((uint8_t *)"Press '2' or 'z' within 2 seconds to use ZMODEM instead.\r\n");
+    SerialPutString((uint8_t *)"Press 'b' within 2 seconds to boot the previous image again.\r\n");
+    SerialPutString((uint8_t *)"Press 't' within 2 seconds to list the last transfers.\r\n");
+    SerialPutString((uint8_t *)"Running from ");
+    SerialShowSlot(SlotGetActive());
+    SerialPutString((uint8_t *)", the image goes to ");
+    SerialShowSlot(SlotGetTarget());
+    SerialPutString((uint8_t *)", pack it for that slot with Scripts/image_pack.py.\r\n");
     SerialPutString((uint8_t *)"Please start sending the firmware file.\r\n\r\n");
 
-    /* Automatically start download */
-    SerialDownload();
+    /* Keep interrupts served while a Flash bank 1 sector is erased */
+    FlashIfRelocateVectors();
+
+    /* Receive through the DMA ring from here on */
+    SerialRxInit();
+
+    /* The selection time starts again after the transfers are listed */
+    do
+    {
+        if (SerialRxReceive(&key, 1, MENU_SELECT_TIMEOUT) != HAL_OK)
+        {
+            key = 0;
+        }
+        if ((key == 't') || (key == 'T'))
+        {
+            SerialShowTelemetry();
+        }
+    } while ((key == 't') || (key == 'T'));
+
+    if ((key == 'b') || (key == 'B'))
+    {
+        SerialRollback();
+    }
+    /* A ZMODEM sender that is already running ("rz\r" then ZRQINIT) selects it too */
+    else if ((key == '2') || (key == 'z') || (key == 'Z') || (key == 'r') || (key == ZPAD))
+    {
+        SerialDownload(Zmodem_Receive);
+    }
+    else
+    {
+        /* Automatically start download */
+        SerialDownload(Ymodem_Receive);
+    }
 
     /* After download completion, restart system to run new firmware */
     SerialPutString((uint8_t *)"\r\nSystem will restart in 3 seconds...\r\n");
     HAL_Delay(1000);
 
+#if (BOOT_KEEP_CLOCKS != 0)
+    /* Start the image directly, the PLL is already running */
+    slot = SlotGetBootSlot();
+    if (slot != SLOT_NONE)
+    {
+        BootStart(slot, BOOT_REASON_NORMAL);
+    }
+#endif
+
     /* Perform system reset */
     NVIC_SystemReset();
 }
@@ -0,0 +1,172 @@
+/* USER CODE BEGIN Header */
+/**
+ ******************************************************************************
+ * @file           : profile.c
+ * @brief          : Cycle counter timers around the bootloader hot paths
+ *
+ *          Each site keeps the call count, the shortest, longest and total
+ *          DWT cycles and a histogram of the call times. The menu prints them
+ *          after each download, so the time per packet can be split into
+ *          receiving, CRC, programming and answering on the board itself. The
+ *          jump site cannot be printed, it goes to the application in the
+ *          handoff block. Only built with BOOT_PROFILE.
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2025 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+/* USER CODE END Header */
+
+/* Includes ------------------------------------------------------------------*/
+#include "profile.h"
+#include "common.h"
+
+#if (BOOT_PROFILE != 0)
+
+/* Private variables ---------------------------------------------------------*/
+ProfileSite aProfileSites[PROFILE_SITE_COUNT];
+
+static const char *const aProfileNames[PROFILE_SITE_COUNT] = {
+    "ReceivePacket", "Packet CRC", "FlashIfProgram", "FlashIfWrite", "Erase wait", "SerialPutByte", "Jump",
+};
+
+/* Upper bounds of the histogram buckets in microseconds, the last one is open */
+static const char *const aProfileBuckets[PROFILE_BUCKETS] = {
+    "<1", "<4", "<16", "<64", "<256", "<1024", "<4096", ">=4096",
+};
+
+/* Private function prototypes -----------------------------------------------*/
+static void ProfilePutNumber(const char *label, uint32_t value);
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Print a label followed by a decimal number
+ * @param  label: text before the number
+ * @param  value: number
+ * @retval None
+ */
+static void ProfilePutNumber(const char *label, uint32_t value)
+{
+    uint8_t number[11] = {0};
+
+    Int2Str(number, value);
+    SerialPutString((uint8_t *)label);
+    SerialPutString(number);
+}
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief  Stop timing a call of a site and account for it
+ * @note   Runs from RAM (.ramcode), the flash driver and the receive path
+ *         call it while a bank is erased or programmed.
+ * @param  site: PROFILE_SITE_xxx, entered with PROFILE_ENTER()
+ * @retval None
+ */
+void ProfileLeave(uint32_t site)
+{
+    const uint32_t cycles = DWT->CYCCNT - aProfileSites[site].Start;
+    const uint32_t micros = cycles / (SystemCoreClock / 1000000U);
+    ProfileSite *entry = &aProfileSites[site];
+    uint32_t bucket = 0;
+
+    if ((entry->Count == 0U) || (cycles < entry->Min))
+    {
+        entry->Min = cycles;
+    }
+    if (cycles > entry->Max)
+    {
+        entry->Max = cycles;
+    }
+    entry->Last = cycles;
+    entry->Total += cycles;
+    entry->Count++;
+
+    /* Buckets grow by 4, from the bit length of the microseconds */
+    if (micros != 0U)
+    {
+        bucket = (33U - __CLZ(micros)) / 2U;
+        if (bucket >= PROFILE_BUCKETS)
+        {
+            bucket = PROFILE_BUCKETS - 1U;
+        }
+    }
+    entry->aBuckets[bucket]++;
+}
+
+/**
+ * @brief  Clear the timers of all sites
+ * @retval None
+ */
+void ProfileReset(void)
+{
+    uint32_t site, bucket;
+
+    for (site = 0; site < PROFILE_SITE_COUNT; site++)
+    {
+        aProfileSites[site].Count = 0;
+        aProfileSites[site].Min = 0;
+        aProfileSites[site].Max = 0;
+        aProfileSites[site].Last = 0;
+        aProfileSites[site].Total = 0;
+        for (bucket = 0; bucket < PROFILE_BUCKETS; bucket++)
+        {
+            aProfileSites[site].aBuckets[bucket] = 0;
+        }
+    }
+}
+
+/**
+ * @brief  Print the timers of the sites that were called on DEBUG_UART
+ * @note   Two lines per site: calls, min/avg/max cycles and the total time,
+ *         then the calls per histogram bucket that are not empty.
+ * @retval None
+ */
+void ProfileDump(void)
+{
+    const uint32_t cyclesPerMs = SystemCoreClock / 1000U;
+    const ProfileSite *entry;
+    uint32_t site, bucket;
+
+    ProfilePutNumber("\r\n Profile, cycles at ", SystemCoreClock / 1000000U);
+    SerialPutString((uint8_t *)" MHz\r\n");
+
+    for (site = 0; site < PROFILE_SITE_COUNT; site++)
+    {
+        entry = &aProfileSites[site];
+        if (entry->Count == 0U)
+        {
+            continue;
+        }
+
+        SerialPutString((uint8_t *)" ");
+        SerialPutString((uint8_t *)aProfileNames[site]);
+        ProfilePutNumber(": ", entry->Count);
+        ProfilePutNumber(" calls, min ", entry->Min);
+        ProfilePutNumber(" avg ", (uint32_t)(entry->Total / entry->Count));
+        ProfilePutNumber(" max ", entry->Max);
+        ProfilePutNumber(", total ", (uint32_t)(entry->Total / cyclesPerMs));
+        SerialPutString((uint8_t *)" ms\r\n  ");
+
+        for (bucket = 0; bucket < PROFILE_BUCKETS; bucket++)
+        {
+            if (entry->aBuckets[bucket] != 0U)
+            {
+                SerialPutString((uint8_t *)" ");
+                SerialPutString((uint8_t *)aProfileBuckets[bucket]);
+                ProfilePutNumber(" us: ", entry->aBuckets[bucket]);
+            }
+        }
+        SerialPutString((uint8_t *)"\r\n");
+    }
+}
+
+#endif /* BOOT_PROFILE */
@@ -0,0 +1,99 @@
+/* USER CODE BEGIN Header */
+/**
+ ******************************************************************************
+ * @file           : profile.h
+ * @brief          : Cycle counter timers around the bootloader hot paths
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2025 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+/* USER CODE END Header */
+
+#ifndef __PROFILE_H__
+#define __PROFILE_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f4xx_hal.h"
+
+/* Exported constants --------------------------------------------------------*/
+/* Set by the CMake option of the same name, on in Debug builds. Without it the
+   PROFILE_xxx macros expand to nothing. */
+#ifndef BOOT_PROFILE
+#define BOOT_PROFILE 0
+#endif
+
+/* Timed sites, a site must not be entered again before it is left */
+#define PROFILE_SITE_RECEIVE ((uint32_t)0) /* ReceivePacket(), the wait for the line included */
+#define PROFILE_SITE_CRC ((uint32_t)1)     /* Packet CRC, once per chunk taken from the ring */
+#define PROFILE_SITE_PROGRAM ((uint32_t)2) /* One slice of a queued write, FlashIfProgram() */
+#define PROFILE_SITE_WRITE ((uint32_t)3)   /* FlashIfWrite() */
+#define PROFILE_SITE_ERASE ((uint32_t)4)   /* CPU blocked on an erase, FlashIfErase() and FlashIfEraseUpTo() */
+#define PROFILE_SITE_PUTBYTE ((uint32_t)5) /* SerialPutByte(), the RS485 direction switch included */
+#define PROFILE_SITE_JUMP ((uint32_t)6)    /* UART and clock shutdown before the jump to an image */
+#define PROFILE_SITE_COUNT ((uint32_t)7)
+
+/* Histogram buckets: below 1 us, then up to 4, 16, ... 4096 us, and above */
+#define PROFILE_BUCKETS ((uint32_t)8)
+
+    /* Exported types ------------------------------------------------------------*/
+    typedef struct
+    {
+        uint32_t Start; /* DWT->CYCCNT when the site was entered */
+        uint32_t Count; /* Calls since the last reset */
+        uint32_t Min;   /* Cycles of the shortest call */
+        uint32_t Max;   /* Cycles of the longest call */
+        uint32_t Last;  /* Cycles of the latest call */
+        uint64_t Total; /* Cycles of all calls */
+        uint32_t aBuckets[PROFILE_BUCKETS];
+    } ProfileSite;
+
+    /* Exported macro ------------------------------------------------------------*/
+#if (BOOT_PROFILE != 0)
+    extern ProfileSite aProfileSites[PROFILE_SITE_COUNT];
+
+    /**
+     * @brief  Start timing a call of a site
+     * @param  site: PROFILE_SITE_xxx
+     * @retval None
+     */
+    static inline void ProfileEnter(uint32_t site)
+    {
+        aProfileSites[site].Start = DWT->CYCCNT;
+    }
+
+#define PROFILE_ENTER(site) ProfileEnter(site)
+#define PROFILE_LEAVE(site) ProfileLeave(site)
+#define PROFILE_RESET() ProfileReset()
+#define PROFILE_DUMP() ProfileDump()
+#define PROFILE_LAST(site) (aProfileSites[site].Last)
+#else
+#define PROFILE_ENTER(site) ((void)0)
+#define PROFILE_LEAVE(site) ((void)0)
+#define PROFILE_RESET() ((void)0)
+#define PROFILE_DUMP() ((void)0)
+#define PROFILE_LAST(site) ((uint32_t)0)
+#endif
+
+    /* Exported functions ------------------------------------------------------- */
+    void ProfileLeave(uint32_t site);
+    void ProfileReset(void);
+    void ProfileDump(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __PROFILE_H__ */
@@ -0,0 +1,683 @@
+/* USER CODE BEGIN Header */
+/**
+ ******************************************************************************
+ * @file           : resume.c
+ * @brief          : Journal of committed transfer progress and slot state
+ *
+ *          Sector 22 holds a log of ResumeRecord entries that are only ever
+ *          appended. A transfer starts with a START record (image identity)
+ *          and a SIZE record, then a COMMIT record is added each time another
+ *          RESUME_COMMIT_STEP bytes are programmed. The value of a record is
+ *          programmed before its tag, so a record cut short by a power loss
+ *          has no valid tag and is skipped. The sector is only erased when it
+ *          cannot hold another transfer.
+ *
+ *          The journal also keeps the slot state: a TARGET record when a
+ *          transfer into a slot starts (its old image is gone), a VALID record
+ *          once a slot holds a complete image and an ACTIVE record for the
+ *          slot to boot. The slot state is written again after the sector is
+ *          erased, the ACTIVE record first. What the journal does not record
+ *          is taken from the slots themselves: a slot without a record is
+ *          valid if it holds a complete image, and without an ACTIVE record
+ *          the valid image with the higher version boots. A new sector, or
+ *          one erased just before a reset, thus keeps booting the same image,
+ *          and an image in slot A of the single slot layout stays active.
+ *
+ *          Before the store compaction erases sector 23, the words it writes
+ *          back are copied here as COPY records, sealed by a SEALED record
+ *          that counts them. A DROPPED record follows once sector 23 is
+ *          written back, so a sealed copy without one is what a reset during
+ *          the rewrite left, and store.c writes it back again.
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2025 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+/* USER CODE END Header */
+
+/* Includes ------------------------------------------------------------------*/
+#include "resume.h"
+#include "crc32.h"
+#include "flash_if.h"
+#include "slot.h"
+
+/* Private define ------------------------------------------------------------*/
+#define RESUME_TAG_START 0x5253A001UL
+#define RESUME_TAG_SIZE 0x5253A002UL
+#define RESUME_TAG_COMMIT 0x5253A004UL
+#define RESUME_TAG_TARGET 0x5253A008UL
+#define RESUME_TAG_VALID 0x5253A010UL
+#define RESUME_TAG_ACTIVE 0x5253A020UL
+#define RESUME_TAG_CRC 0x5253A040UL      /* + slot, the value is the image CRC */
+#define RESUME_TAG_VERIFIED 0x5253A080UL /* + slot, the value identifies the checked image */
+#define RESUME_TAG_SEALED 0x5253A100UL   /* The value counts the COPY records just before */
+#define RESUME_TAG_DROPPED 0x5253A200UL
+#define RESUME_TAG_COPY 0x52540000UL /* + word index in sector 23, the value is the word */
+#define RESUME_COPY_MASK 0xFFFF0000UL
+#define RESUME_TAG_FREE 0xFFFFFFFFUL
+
+#define RESUME_RECORDS (RESUME_SIZE / sizeof(ResumeRecord))
+/* Records a transfer needs besides its commits: target, start, size, the
+   last commit, and the slot state written again after an erase */
+#define RESUME_RESERVED ((uint32_t)12)
+
+/* Private typedef -----------------------------------------------------------*/
+/* State of the last transfer found in the journal */
+typedef struct
+{
+    uint32_t identity;
+    uint32_t size;
+    uint32_t committed;
+    uint32_t valid; /* START and SIZE records present */
+    uint32_t next;  /* index of the first free record */
+    uint32_t target;
+    uint32_t activeSlot;
+    uint32_t validSlots; /* bit per slot holding a complete image */
+    uint32_t imageCrc[SLOT_COUNT];
+    uint32_t verifiedSlots; /* bit per slot with a verified marker */
+    uint32_t verified[SLOT_COUNT];
+    uint32_t copyFirst; /* index of the first COPY record of a sealed copy */
+    uint32_t copyCount; /* words in the sealed copy, 0 once dropped */
+} ResumeState;
+
+/* Private variables ---------------------------------------------------------*/
+static ResumeState resumeState;
+static uint32_t resumeScanned; /* resumeState holds the journal */
+static uint32_t resumeActive;
+static uint32_t resumeBase; /* Start of the slot the transfer writes */
+
+/* Private function prototypes -----------------------------------------------*/
+static void ResumeScan(ResumeState *state);
+static void ResumeLoad(void);
+static void ResumeRebuild(ResumeState *state, uint32_t recordedSlots);
+static uint32_t ResumeAppend(uint32_t tag, uint32_t value);
+static uint32_t ResumeIsBlank(uint32_t start, uint32_t end);
+static uint32_t ResumeReserve(uint32_t count);
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Read the journal back
+ * @param  state: last transfer and append position
+ * @retval None
+ */
+static void ResumeScan(ResumeState *state)
+{
+    const ResumeRecord *record = (const ResumeRecord *)RESUME_ADDRESS;
+    uint32_t i, recordedSlots = 0, copyRun = 0;
+
+    state->identity = 0;
+    state->size = 0;
+    state->committed = 0;
+    state->valid = 0;
+    state->target = SLOT_NONE;
+    state->activeSlot = SLOT_NONE;
+    state->validSlots = 0;
+    state->imageCrc[SLOT_A] = 0;
+    state->imageCrc[SLOT_B] = 0;
+    state->verifiedSlots = 0;
+    state->copyCount = 0;
+
+    for (i = 0; i < RESUME_RECORDS; i++)
+    {
+        if ((record[i].Tag == RESUME_TAG_FREE) && (record[i].Value == RESUME_TAG_FREE))
+        {
+            break;
+        }
+
+        if ((record[i].Tag & RESUME_COPY_MASK) == RESUME_TAG_COPY)
+        {
+            copyRun++;
+            continue;
+        }
+
+        if (((record[i].Tag == RESUME_TAG_TARGET) || (record[i].Tag == RESUME_TAG_VALID) ||
+             (record[i].Tag == RESUME_TAG_ACTIVE)) &&
+            (record[i].Value >= SLOT_COUNT))
+        {
+            /* Slot records only carry a slot number */
+            continue;
+        }
+
+        switch (record[i].Tag)
+        {
+        case RESUME_TAG_START:
+            state->identity = record[i].Value;
+            state->size = 0;
+            state->committed = 0;
+            state->valid = 0;
+            break;
+        case RESUME_TAG_SIZE:
+            state->size = record[i].Value;
+            state->valid = 1;
+            break;
+        case RESUME_TAG_COMMIT:
+            state->committed = record[i].Value;
+            break;
+        case RESUME_TAG_TARGET:
+            state->target = record[i].Value;
+            recordedSlots |= 1UL << record[i].Value;
+            state->validSlots &= ~(1UL << record[i].Value);
+            state->imageCrc[record[i].Value] = 0;
+            state->verifiedSlots &= ~(1UL << record[i].Value);
+            break;
+        case RESUME_TAG_VALID:
+            recordedSlots |= 1UL << record[i].Value;
+            state->validSlots |= 1UL << record[i].Value;
+            break;
+        case RESUME_TAG_ACTIVE:
+            state->activeSlot = record[i].Value;
+            break;
+        case RESUME_TAG_CRC + SLOT_A:
+            state->imageCrc[SLOT_A] = record[i].Value;
+            break;
+        case RESUME_TAG_CRC + SLOT_B:
+            state->imageCrc[SLOT_B] = record[i].Value;
+            break;
+        case RESUME_TAG_VERIFIED + SLOT_A:
+            state->verified[SLOT_A] = record[i].Value;
+            state->verifiedSlots |= 1UL << SLOT_A;
+            break;
+        case RESUME_TAG_VERIFIED + SLOT_B:
+            state->verified[SLOT_B] = record[i].Value;
+            state->verifiedSlots |= 1UL << SLOT_B;
+            break;
+        case RESUME_TAG_SEALED:
+            /* Only complete if all its words are there */
+            if ((record[i].Value != 0U) && (record[i].Value == copyRun))
+            {
+                state->copyFirst = i - copyRun;
+                state->copyCount = copyRun;
+            }
+            break;
+        case RESUME_TAG_DROPPED:
+            state->copyCount = 0;
+            break;
+        default:
+            /* Interrupted while programming, ignore */
+            break;
+        }
+        copyRun = 0;
+    }
+    state->next = i;
+
+    ResumeRebuild(state, recordedSlots);
+}
+
+/**
+ * @brief  Fill in the slot state the journal does not record
+ * @note   Constant time, only the header and trailer of the images are read.
+ * @param  state: state read from the journal
+ * @param  recordedSlots: bit per slot with a TARGET or VALID record
+ * @retval None
+ */
+static void ResumeRebuild(ResumeState *state, uint32_t recordedSlots)
+{
+    uint32_t slot;
+
+    for (slot = 0; slot < SLOT_COUNT; slot++)
+    {
+        if (((recordedSlots & (1UL << slot)) == 0U) && (SlotIsComplete(slot) != 0U))
+        {
+            state->validSlots |= 1UL << slot;
+        }
+    }
+
+    if (state->activeSlot == SLOT_NONE)
+    {
+        /* The newer image, slot A if they are the same or neither is valid */
+        state->activeSlot = ((state->validSlots == (1UL << SLOT_B)) ||
+                             ((state->validSlots == ((1UL << SLOT_A) | (1UL << SLOT_B))) &&
+                              (SlotGetVersion(SLOT_B) > SlotGetVersion(SLOT_A))))
+                                ? SLOT_B
+                                : SLOT_A;
+    }
+}
+
+/**
+ * @brief  Read the journal into resumeState unless this was done before
+ * @note   Only this module writes sector 22 and it keeps resumeState up to
+ *         date, so the journal is scanned once per boot.
+ * @retval None
+ */
+static void ResumeLoad(void)
+{
+    if (resumeScanned == 0U)
+    {
+        ResumeScan(&resumeState);
+        resumeScanned = 1;
+    }
+}
+
+/**
+ * @brief  Append one record to the journal
+ * @param  tag: record type
+ * @param  value: record content
+ * @retval FLASHIF_OK if written
+ */
+static uint32_t ResumeAppend(uint32_t tag, uint32_t value)
+{
+    const uint32_t address = RESUME_ADDRESS + (resumeState.next * sizeof(ResumeRecord));
+
+    if (resumeState.next >= RESUME_RECORDS)
+    {
+        return FLASHIF_WRITING_ERROR;
+    }
+    resumeState.next++;
+
+    FlashIfInit();
+    /* Value first, the tag makes the record valid */
+    if ((HAL_FLASH_Program(TYPEPROGRAM_WORD, address + 4U, value) != HAL_OK) ||
+        (HAL_FLASH_Program(TYPEPROGRAM_WORD, address, tag) != HAL_OK))
+    {
+        return FLASHIF_WRITING_ERROR;
+    }
+
+    return FLASHIF_OK;
+}
+
+/**
+ * @brief  Check that a flash range is erased
+ * @param  start: first address
+ * @param  end: address after the range
+ * @retval 1 if every word reads 0xFFFFFFFF
+ */
+static uint32_t ResumeIsBlank(uint32_t start, uint32_t end)
+{
+    for (; start < end; start += 4U)
+    {
+        if (*(__IO uint32_t *)start != 0xFFFFFFFFUL)
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * @brief  Make room for a number of records
+ * @note   Erases the sector when it is too full, which drops the transfer in
+ *         the journal, then writes the slot state again. Slots without an
+ *         image go first so that they are not taken for valid, then the
+ *         ACTIVE record. A reset in between leaves the rest to
+ *         ResumeRebuild(), which finds the same state in the slots. A copy
+ *         of sector 23 still sealed is dropped; store.c writes it back the
+ *         first time the store is read, before anything is appended here.
+ * @param  count: records about to be appended
+ * @retval FLASHIF_OK, or an error if the journal could not be rewritten
+ */
+static uint32_t ResumeReserve(uint32_t count)
+{
+    FLASH_EraseInitTypeDef eraseInit;
+    uint32_t sectorError, slot, status = FLASHIF_OK;
+
+    if ((resumeState.next + count) <= RESUME_RECORDS)
+    {
+        return FLASHIF_OK;
+    }
+
+    FlashIfInit();
+    eraseInit.TypeErase = TYPEERASE_SECTORS;
+    eraseInit.Sector = RESUME_SECTOR;
+    eraseInit.NbSectors = 1;
+    eraseInit.VoltageRange = VOLTAGE_RANGE_3;
+    if (HAL_FLASHEx_Erase(&eraseInit, &sectorError) != HAL_OK)
+    {
+        /* The sector may be partly erased, read it again next time */
+        resumeScanned = 0;
+        return FLASHIF_ERASEKO;
+    }
+    resumeState.next = 0;
+    resumeState.valid = 0;
+    resumeState.target = SLOT_NONE;
+    resumeState.copyCount = 0;
+
+    for (slot = 0; slot < SLOT_COUNT; slot++)
+    {
+        if ((resumeState.validSlots & (1UL << slot)) == 0U)
+        {
+            status |= ResumeAppend(RESUME_TAG_TARGET, slot);
+        }
+    }
+    status |= ResumeAppend(RESUME_TAG_ACTIVE, resumeState.activeSlot);
+    for (slot = 0; slot < SLOT_COUNT; slot++)
+    {
+        if ((resumeState.validSlots & (1UL << slot)) != 0U)
+        {
+            status |= ResumeAppend(RESUME_TAG_CRC + slot, resumeState.imageCrc[slot]);
+            status |= ResumeAppend(RESUME_TAG_VALID, slot);
+        }
+        if ((resumeState.verifiedSlots & (1UL << slot)) != 0U)
+        {
+            status |= ResumeAppend(RESUME_TAG_VERIFIED + slot, resumeState.verified[slot]);
+        }
+    }
+
+    return (status == FLASHIF_OK) ? FLASHIF_OK : FLASHIF_WRITING_ERROR;
+}
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief  Identity of an image, CRC-32 of its name and file information
+ * @param  fileInfo: "name\0size mtime ...\0" as sent in block 0 / ZFILE
+ * @param  length: number of valid bytes at fileInfo
+ * @retval Identity value
+ */
+uint32_t ResumeGetIdentity(const uint8_t *fileInfo, uint32_t length)
+{
+    uint32_t i, fields = 0;
+
+    /* Up to and including the NUL after the file information */
+    for (i = 0; (i < length) && (fields < 2U); i++)
+    {
+        if (fileInfo[i] == 0U)
+        {
+            fields++;
+        }
+    }
+
+    return Crc32Update(0, fileInfo, i);
+}
+
+/**
+ * @brief  Start or continue the transfer of an image
+ * @note   When the journal holds an unfinished transfer of the same image the
+ *         programmed part is kept. Flash from the returned offset up to the
+ *         end of its sector is guaranteed to be erased, the caller erases the
+ *         following sectors. Otherwise a new transfer is recorded and 0 is
+ *         returned.
+ * @param  slot: slot the image is written to
+ * @param  identity: image identity from ResumeGetIdentity()
+ * @param  size: image size in bytes
+ * @param  canResume: 0 if the sender can only start from the beginning
+ * @retval Offset in the image to continue from
+ */
+uint32_t ResumeBegin(uint32_t slot, uint32_t identity, uint32_t size, uint32_t canResume)
+{
+    uint32_t offset, address;
+
+    ResumeLoad();
+    resumeActive = 1;
+    resumeBase = SlotGetAddress(slot);
+
+    if ((canResume != 0U) && (resumeState.valid != 0U) && (resumeState.target == slot) &&
+        (resumeState.identity == identity) && (resumeState.size == size) && (resumeState.committed > 0U) &&
+        (resumeState.committed < size))
+    {
+        offset = resumeState.committed;
+        address = resumeBase + offset;
+
+        /* Words after the commit point may have been programmed before the
+           power went away, fall back to the start of the sector then */
+        if (ResumeIsBlank(address, FlashIfGetSectorEnd(address)) == 0U)
+        {
+            offset = FlashIfGetSectorStart(address) - resumeBase;
+            resumeState.committed = offset;
+        }
+        return offset;
+    }
+
+    /* Room for the transfer and one commit per step */
+    resumeState.identity = identity;
+    resumeState.size = size;
+    resumeState.committed = 0;
+    if ((ResumeReserve(RESUME_RESERVED + (size / RESUME_COMMIT_STEP)) != FLASHIF_OK) ||
+        (ResumeAppend(RESUME_TAG_TARGET, slot) != FLASHIF_OK) ||
+        (ResumeAppend(RESUME_TAG_START, identity) != FLASHIF_OK) ||
+        (ResumeAppend(RESUME_TAG_SIZE, size) != FLASHIF_OK))
+    {
+        /* Transfer still works, it just cannot be resumed */
+        resumeActive = 0;
+    }
+
+    resumeState.target = slot;
+    resumeState.validSlots &= ~(1UL << slot);
+    resumeState.imageCrc[slot] = 0;
+    resumeState.verifiedSlots &= ~(1UL << slot);
+    resumeState.valid = 1;
+
+    return 0;
+}
+
+/**
+ * @brief  Record programming progress
+ * @note   A record is written each RESUME_COMMIT_STEP bytes and when the whole
+ *         image is in.
+ * @param  address: end of the contiguous programmed part of the image, as
+ *         returned by FlashIfGetProgrammed()
+ * @retval None
+ */
+void ResumeCommit(uint32_t address)
+{
+    const uint32_t offset = address - resumeBase;
+
+    /* The journal cannot be programmed while a sector erases, catch up later */
+    if ((resumeActive == 0U) || (address < resumeBase) || (FlashIfIsErasing() != 0U))
+    {
+        return;
+    }
+
+    if ((offset >= resumeState.size) && (resumeState.committed < resumeState.size))
+    {
+        resumeState.committed = offset;
+    }
+    else if ((offset < resumeState.size) && (offset >= (resumeState.committed + RESUME_COMMIT_STEP)))
+    {
+        resumeState.committed = offset - (offset % RESUME_COMMIT_STEP);
+    }
+    else
+    {
+        return;
+    }
+
+    if (ResumeAppend(RESUME_TAG_COMMIT, resumeState.committed) != FLASHIF_OK)
+    {
+        resumeActive = 0;
+    }
+}
+
+/**
+ * @brief  Slot selected for booting
+ * @retval SLOT_A or SLOT_B
+ */
+uint32_t ResumeGetActiveSlot(void)
+{
+    ResumeLoad();
+
+    return (resumeState.activeSlot == SLOT_B) ? SLOT_B : SLOT_A;
+}
+
+/**
+ * @brief  Slots that hold a complete image
+ * @retval Bit mask, bit n set for slot n
+ */
+uint32_t ResumeGetValidSlots(void)
+{
+    ResumeLoad();
+
+    return resumeState.validSlots;
+}
+
+/**
+ * @brief  Record the slot to boot
+ * @param  slot: SLOT_A or SLOT_B
+ * @retval FLASHIF_OK if written
+ */
+uint32_t ResumeSetActiveSlot(uint32_t slot)
+{
+    ResumeLoad();
+    if (ResumeReserve(1) != FLASHIF_OK)
+    {
+        return FLASHIF_WRITING_ERROR;
+    }
+    resumeState.activeSlot = slot;
+
+    return ResumeAppend(RESUME_TAG_ACTIVE, slot);
+}
+
+/**
+ * @brief  Record that a slot holds a complete image
+ * @param  slot: SLOT_A or SLOT_B
+ * @param  crc: CRC-32 of the image
+ * @retval FLASHIF_OK if written
+ */
+uint32_t ResumeSetSlotValid(uint32_t slot, uint32_t crc)
+{
+    ResumeLoad();
+    if (ResumeReserve(2) != FLASHIF_OK)
+    {
+        return FLASHIF_WRITING_ERROR;
+    }
+    resumeState.imageCrc[slot] = crc;
+    resumeState.validSlots |= 1UL << slot;
+
+    /* CRC first, the slot only counts once it is valid */
+    if (ResumeAppend(RESUME_TAG_CRC + slot, crc) != FLASHIF_OK)
+    {
+        return FLASHIF_WRITING_ERROR;
+    }
+
+    return ResumeAppend(RESUME_TAG_VALID, slot);
+}
+
+/**
+ * @brief  CRC recorded for the image in a slot
+ * @param  slot: SLOT_A or SLOT_B
+ * @retval CRC-32, 0 if the slot was never activated with one
+ */
+uint32_t ResumeGetSlotCrc(uint32_t slot)
+{
+    ResumeLoad();
+
+    return (slot < SLOT_COUNT) ? resumeState.imageCrc[slot] : 0U;
+}
+
+/**
+ * @brief  Record that the image in a slot was checked in full
+ * @param  slot: SLOT_A or SLOT_B
+ * @param  identity: value that changes with the image, its header CRC
+ * @retval FLASHIF_OK if written
+ */
+uint32_t ResumeSetSlotVerified(uint32_t slot, uint32_t identity)
+{
+    ResumeLoad();
+    if (ResumeReserve(1) != FLASHIF_OK)
+    {
+        return FLASHIF_WRITING_ERROR;
+    }
+    resumeState.verified[slot] = identity;
+    resumeState.verifiedSlots |= 1UL << slot;
+
+    return ResumeAppend(RESUME_TAG_VERIFIED + slot, identity);
+}
+
+/**
+ * @brief  Check for a verified marker
+ * @param  slot: SLOT_A or SLOT_B
+ * @param  identity: identity of the image in the slot now
+ * @retval 1 if this image was checked in full before
+ */
+uint32_t ResumeIsSlotVerified(uint32_t slot, uint32_t identity)
+{
+    ResumeLoad();
+
+    return ((slot < SLOT_COUNT) && ((resumeState.verifiedSlots & (1UL << slot)) != 0U) &&
+            (resumeState.verified[slot] == identity))
+               ? 1U
+               : 0U;
+}
+
+/**
+ * @brief  Make room for a copy of the words written back to sector 23
+ * @note   Room for the SEALED and DROPPED records as well, so the journal is
+ *         not erased while the copy is needed.
+ * @param  count: words about to be copied
+ * @retval FLASHIF_OK if there is room
+ */
+uint32_t ResumeCopyBegin(uint32_t count)
+{
+    ResumeLoad();
+
+    return ResumeReserve(count + 2U);
+}
+
+/**
+ * @brief  Copy one word
+ * @param  index: word index in sector 23
+ * @param  word: value to write back there
+ * @retval FLASHIF_OK if written
+ */
+uint32_t ResumeCopyWord(uint32_t index, uint32_t word)
+{
+    ResumeLoad();
+    if (index > ~RESUME_COPY_MASK)
+    {
+        return FLASHIF_WRITING_ERROR;
+    }
+
+    return ResumeAppend(RESUME_TAG_COPY + index, word);
+}
+
+/**
+ * @brief  Seal or drop the copy
+ * @param  count: words copied since ResumeCopyBegin(), 0 to drop the copy
+ *         once sector 23 is written back
+ * @retval FLASHIF_OK if written
+ */
+uint32_t ResumeCopyEnd(uint32_t count)
+{
+    ResumeLoad();
+    if (count == 0U)
+    {
+        if (resumeState.copyCount == 0U)
+        {
+            return FLASHIF_OK;
+        }
+        if (ResumeReserve(1) != FLASHIF_OK)
+        {
+            return FLASHIF_WRITING_ERROR;
+        }
+        resumeState.copyCount = 0;
+
+        return ResumeAppend(RESUME_TAG_DROPPED, 0);
+    }
+
+    if (ResumeAppend(RESUME_TAG_SEALED, count) != FLASHIF_OK)
+    {
+        return FLASHIF_WRITING_ERROR;
+    }
+    resumeState.copyFirst = resumeState.next - 1U - count;
+    resumeState.copyCount = count;
+
+    return FLASHIF_OK;
+}
+
+/**
+ * @brief  Read a word of the sealed copy
+ * @param  position: 0 to the number of words - 1
+ * @param  index: word index in sector 23
+ * @param  word: value to write back there
+ * @retval Number of words in the copy, 0 if there is none
+ */
+uint32_t ResumeGetCopy(uint32_t position, uint32_t *index, uint32_t *word)
+{
+    const ResumeRecord *record = (const ResumeRecord *)RESUME_ADDRESS;
+
+    ResumeLoad();
+    if (position < resumeState.copyCount)
+    {
+        *index = record[resumeState.copyFirst + position].Tag & ~RESUME_COPY_MASK;
+        *word = record[resumeState.copyFirst + position].Value;
+    }
+
+    return resumeState.copyCount;
+}
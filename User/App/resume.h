@@ -0,0 +1,69 @@
+/* USER CODE BEGIN Header */
+/**
+ ******************************************************************************
+ * @file           : resume.h
+ * @brief          : Journal of committed transfer progress and slot state
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2025 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+/* USER CODE END Header */
+
+#ifndef __RESUME_H__
+#define __RESUME_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+// 断点续传记录保存在Flash扇区22 (0x081C0000-0x081DFFFF, 128KB)
+#define RESUME_SECTOR 22
+#define RESUME_ADDRESS 0x081C0000UL
+#define RESUME_SIZE 0x00020000UL
+
+/* Progress is recorded every RESUME_COMMIT_STEP bytes, a multiple of every
+   block size so that a resumed transfer restarts on a block boundary */
+#define RESUME_COMMIT_STEP ((uint32_t)0x2000)
+
+    /* Exported types ------------------------------------------------------------*/
+    /* Journal record, appended with two word programs and never rewritten */
+    typedef struct
+    {
+        uint32_t Tag;   // 记录类型
+        uint32_t Value; // 记录内容
+    } ResumeRecord;
+
+    /* Exported functions ------------------------------------------------------- */
+    uint32_t ResumeGetIdentity(const uint8_t *fileInfo, uint32_t length);
+    uint32_t ResumeBegin(uint32_t slot, uint32_t identity, uint32_t size, uint32_t canResume);
+    void ResumeCommit(uint32_t address);
+    uint32_t ResumeGetActiveSlot(void);
+    uint32_t ResumeGetValidSlots(void);
+    uint32_t ResumeSetActiveSlot(uint32_t slot);
+    uint32_t ResumeSetSlotValid(uint32_t slot, uint32_t crc);
+    uint32_t ResumeGetSlotCrc(uint32_t slot);
+    uint32_t ResumeSetSlotVerified(uint32_t slot, uint32_t identity);
+    uint32_t ResumeIsSlotVerified(uint32_t slot, uint32_t identity);
+    uint32_t ResumeCopyBegin(uint32_t count);
+    uint32_t ResumeCopyWord(uint32_t index, uint32_t word);
+    uint32_t ResumeCopyEnd(uint32_t count);
+    uint32_t ResumeGetCopy(uint32_t position, uint32_t *index, uint32_t *word);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RESUME_H__ */
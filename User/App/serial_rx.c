@@ -0,0 +1,303 @@
+/* USER CODE BEGIN Header */
+/**
+ ******************************************************************************
+ * @file           : serial_rx.c
+ * @brief          : DMA circular receive ring for the transfer UART
+ *
+ *          DEBUG_UART is received by DMA into a circular buffer, so bytes keep
+ *          arriving while the CPU is busy programming flash or sending an ACK.
+ *          The ring position is tracked from the DMA counter; the half/full
+ *          transfer and IDLE-line events (HAL_UARTEx_ReceiveToIdle_DMA) keep
+ *          the running byte count current and expose a reader that falls a
+ *          ring behind.
+ *
+ *          The count is only exact while an event is serviced at least once
+ *          per ring, SerialRxGetHoldTime(). If the CPU stalls longer, on an
+ *          erase of the bank it runs from or with interrupts masked, the DMA
+ *          laps the ring between two events and the lost lap cannot be told
+ *          apart from a short delta: it is neither counted nor reported. The
+ *          receivers keep their stalls below the hold time, see
+ *          FlashIfEraseSlowSectors().
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2025 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+/* USER CODE END Header */
+
+/* Includes ------------------------------------------------------------------*/
+#include "serial_rx.h"
+#include "usart.h"
+
+/* Private define ------------------------------------------------------------*/
+#define SERIAL_RX_MASK (SERIAL_RX_BUFFER_SIZE - 1U)
+
+/* Private variables ---------------------------------------------------------*/
+static uint8_t aRxRing[SERIAL_RX_BUFFER_SIZE];
+static volatile uint32_t rxHead;    /* Total bytes written by the DMA */
+static volatile uint32_t rxLastPos; /* DMA write position at the last update */
+static uint32_t rxTail;             /* Total bytes consumed by the reader */
+static volatile uint32_t rxOverruns;
+static SerialRxIdleHook rxIdleHook;
+
+/* Private function prototypes -----------------------------------------------*/
+static uint32_t SerialRxUpdateHead(void);
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Advance the running byte count to the current DMA write position
+ * @note   Called from the Rx event interrupt and with interrupts masked from
+ *         the reader. The events fire every half ring; a full lap without
+ *         one serviced is lost from the count, see the file header.
+ * @retval Total number of bytes received so far
+ */
+static uint32_t SerialRxUpdateHead(void)
+{
+    uint32_t pos = SERIAL_RX_BUFFER_SIZE - __HAL_DMA_GET_COUNTER(DEBUG_UART.hdmarx);
+
+    rxHead += (pos - rxLastPos) & SERIAL_RX_MASK;
+    rxLastPos = pos & SERIAL_RX_MASK;
+
+    return rxHead;
+}
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief  Start circular DMA reception on DEBUG_UART
+ * @retval None
+ */
+void SerialRxInit(void)
+{
+    rxHead = 0;
+    rxLastPos = 0;
+    rxTail = 0;
+
+    if (HAL_UARTEx_ReceiveToIdle_DMA(&DEBUG_UART, aRxRing, SERIAL_RX_BUFFER_SIZE) != HAL_OK)
+    {
+        return;
+    }
+
+    /* Line errors are caught by the packet CRC, do not let them stop the DMA */
+    __HAL_UART_DISABLE_IT(&DEBUG_UART, UART_IT_PE);
+    __HAL_UART_DISABLE_IT(&DEBUG_UART, UART_IT_ERR);
+}
+
+/**
+ * @brief  Stop DMA reception, DEBUG_UART can be used in blocking mode again
+ * @note   Called before the jump, so the DMA no longer writes the ring in RAM
+ *         the application owns by then.
+ * @retval None
+ */
+void SerialRxStop(void)
+{
+    HAL_UART_AbortReceive(&DEBUG_UART);
+}
+
+/**
+ * @brief  Drop everything received so far
+ * @retval None
+ */
+void SerialRxFlush(void)
+{
+    uint32_t primask = __get_PRIMASK();
+
+    __disable_irq();
+    rxTail = SerialRxUpdateHead();
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief  Number of received bytes not yet consumed
+ * @retval Byte count, capped to the ring size
+ */
+uint32_t SerialRxAvailable(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    uint32_t head;
+
+    __disable_irq();
+    head = SerialRxUpdateHead();
+    __set_PRIMASK(primask);
+
+    if ((head - rxTail) > SERIAL_RX_BUFFER_SIZE)
+    {
+        /* The DMA lapped the reader, the oldest bytes are gone */
+        rxOverruns++;
+        rxTail = head;
+    }
+
+    return head - rxTail;
+}
+
+/**
+ * @brief  Copy up to size bytes out of the ring without waiting
+ * @param  data: destination buffer
+ * @param  size: maximum number of bytes to copy
+ * @retval Number of bytes copied
+ */
+uint32_t SerialRxRead(uint8_t *data, uint32_t size)
+{
+    uint32_t count = SerialRxAvailable();
+    uint32_t i;
+
+    if (count > size)
+    {
+        count = size;
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        data[i] = aRxRing[(rxTail + i) & SERIAL_RX_MASK];
+    }
+    rxTail += count;
+
+    return count;
+}
+
+/**
+ * @brief  Receive an amount of data from the ring, blocking mode
+ * @note   Drop-in replacement for HAL_UART_Receive on DEBUG_UART while the
+ *         DMA owns the receiver.
+ * @param  data: destination buffer
+ * @param  size: number of bytes to receive
+ * @param  timeout: timeout duration in ms
+ * @retval HAL_OK, HAL_TIMEOUT, or HAL_ERROR if the ring overflowed meanwhile
+ */
+HAL_StatusTypeDef SerialRxReceive(uint8_t *data, uint32_t size, uint32_t timeout)
+{
+    const uint32_t tickStart = HAL_GetTick();
+    const uint32_t overruns = rxOverruns;
+    uint32_t received = 0;
+
+    while (received < size)
+    {
+        const uint32_t count = SerialRxRead(&data[received], size - received);
+
+        received += count;
+        if (rxOverruns != overruns)
+        {
+            return HAL_ERROR;
+        }
+        if (received < size)
+        {
+            if ((timeout != HAL_MAX_DELAY) && ((HAL_GetTick() - tickStart) > timeout))
+            {
+                return HAL_TIMEOUT;
+            }
+            /* The line is quiet, let the caller do background work */
+            if ((count == 0U) && (rxIdleHook != NULL))
+            {
+                rxIdleHook();
+            }
+        }
+    }
+
+    return HAL_OK;
+}
+
+/**
+ * @brief  Receive whatever is available from the ring, at least one byte
+ * @note   Returns as soon as data is there, so the caller can work on it while
+ *         the rest of a frame is still on the line.
+ * @param  data: destination buffer
+ * @param  size: maximum number of bytes to receive
+ * @param  received: number of bytes copied
+ * @param  timeout: timeout duration in ms for the first byte
+ * @retval HAL_OK, HAL_TIMEOUT, or HAL_ERROR if the ring overflowed meanwhile
+ */
+HAL_StatusTypeDef SerialRxReceiveSome(uint8_t *data, uint32_t size, uint32_t *received, uint32_t timeout)
+{
+    const uint32_t tickStart = HAL_GetTick();
+    const uint32_t overruns = rxOverruns;
+
+    *received = 0;
+    while ((*received == 0U) && (size > 0U))
+    {
+        *received = SerialRxRead(data, size);
+        if (rxOverruns != overruns)
+        {
+            return HAL_ERROR;
+        }
+        if (*received == 0U)
+        {
+            if ((timeout != HAL_MAX_DELAY) && ((HAL_GetTick() - tickStart) > timeout))
+            {
+                return HAL_TIMEOUT;
+            }
+            if (rxIdleHook != NULL)
+            {
+                rxIdleHook();
+            }
+        }
+    }
+
+    return HAL_OK;
+}
+
+/**
+ * @brief  Install the function called while SerialRxReceive waits for data
+ * @param  hook: function to call, NULL to wait idle
+ * @retval None
+ */
+void SerialRxSetIdleHook(SerialRxIdleHook hook)
+{
+    rxIdleHook = hook;
+}
+
+/**
+ * @brief  Number of ring overruns since power-up
+ * @retval Overrun count
+ */
+uint32_t SerialRxGetOverruns(void)
+{
+    return rxOverruns;
+}
+
+/**
+ * @brief  How long the ring can fill while nothing is read from it
+ * @note   At the DEBUG_UART rate, ten bits per byte.
+ * @retval Milliseconds
+ */
+uint32_t SerialRxGetHoldTime(void)
+{
+    return (SERIAL_RX_BUFFER_SIZE * 10000U) / DEBUG_UART.Init.BaudRate;
+}
+
+/**
+ * @brief  Rx event callback (half transfer, transfer complete, IDLE line)
+ * @param  huart: UART handle
+ * @param  Size: DMA write position in the ring
+ * @retval None
+ */
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size)
+{
+    UNUSED(Size);
+
+    if (huart == &DEBUG_UART)
+    {
+        (void)SerialRxUpdateHead();
+    }
+}
+
+/**
+ * @brief  UART error callback, restarts the ring if the HAL aborted it
+ * @param  huart: UART handle
+ * @retval None
+ */
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+    if ((huart == &DEBUG_UART) && (huart->RxState == HAL_UART_STATE_READY))
+    {
+        rxOverruns++;
+        SerialRxInit();
+    }
+}
@@ -0,0 +1,57 @@
+/* USER CODE BEGIN Header */
+/**
+ ******************************************************************************
+ * @file           : serial_rx.h
+ * @brief          : DMA circular receive ring for the transfer UART
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2025 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+/* USER CODE END Header */
+
+#ifndef __SERIAL_RX_H__
+#define __SERIAL_RX_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f4xx_hal.h"
+
+/* Exported constants --------------------------------------------------------*/
+/* Size of the DMA ring, must be a power of two and fit the 16-bit DMA counter.
+   32 KB holds about 700 ms of traffic at 460800 baud: a streaming sender keeps
+   going while a 16 KB sector erases in the background, programming waits. */
+#define SERIAL_RX_BUFFER_SIZE ((uint32_t)32768)
+
+    /* Exported types ------------------------------------------------------------*/
+    /* Called while SerialRxReceive waits for more bytes */
+    typedef void (*SerialRxIdleHook)(void);
+
+    /* Exported functions ------------------------------------------------------- */
+    void SerialRxInit(void);
+    void SerialRxStop(void);
+    void SerialRxFlush(void);
+    uint32_t SerialRxAvailable(void);
+    uint32_t SerialRxRead(uint8_t *data, uint32_t size);
+    HAL_StatusTypeDef SerialRxReceive(uint8_t *data, uint32_t size, uint32_t timeout);
+    HAL_StatusTypeDef SerialRxReceiveSome(uint8_t *data, uint32_t size, uint32_t *received, uint32_t timeout);
+    uint32_t SerialRxGetOverruns(void);
+    uint32_t SerialRxGetHoldTime(void);
+    void SerialRxSetIdleHook(SerialRxIdleHook hook);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SERIAL_RX_H__ */
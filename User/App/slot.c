@@ -0,0 +1,334 @@
+/* USER CODE BEGIN Header */
+/**
+ ******************************************************************************
+ * @file           : slot.c
+ * @brief          : A/B application slots
+ *
+ *          Slot A lives in Flash bank 1 and slot B in bank 2. A download goes
+ *          to the slot that is not active, so the running image stays
+ *          bootable until the new one is complete and checked. Which slot
+ *          boots and which slots hold a complete image is kept in the resume
+ *          journal, so switching or rolling back writes one record and copies
+ *          nothing. Images are not moved between slots, each one is linked for
+ *          the address of the slot it is sent to.
+ *
+ *          An image packed with Scripts/image_pack.py is judged by its header
+ *          and trailer (image.h). A plain binary without header is still
+ *          accepted by looking at its vector table, so images already in the
+ *          field keep booting.
+ *
+ *          A packed image is also checked in full once, by the CRC unit, and
+ *          a verified marker tied to its header CRC is kept in the journal.
+ *          Later boots find the marker and skip the scan until the image
+ *          changes.
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2025 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+/* USER CODE END Header */
+
+/* Includes ------------------------------------------------------------------*/
+#include "slot.h"
+#include "crc32.h"
+#include "image.h"
+#include "resume.h"
+
+#include <stddef.h>
+
+/* Private function prototypes -----------------------------------------------*/
+static uint8_t SlotHasVectors(uint32_t slot);
+static uint8_t SlotIsVerified(uint32_t slot, uint32_t mayRead);
+
+/* Private variables ---------------------------------------------------------*/
+static uint32_t slotVerifyTime; /* Microseconds spent by the last full check */
+static uint32_t slotVerifyCold; /* 1 if it read the whole image, 0 if the marker was found */
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Check the vector table of an image without header
+ * @param  slot: SLOT_A or SLOT_B
+ * @retval 1 if the stack pointer is in RAM and the reset handler in the slot
+ */
+static uint8_t SlotHasVectors(uint32_t slot)
+{
+    const uint32_t address = SlotGetAddress(slot);
+    const uint32_t sp = *(__IO uint32_t *)address;
+    const uint32_t reset = *(__IO uint32_t *)(address + 4U);
+
+    if (!((sp >= 0x20000000 && sp <= 0x2001FFFF) || // SRAM1
+          (sp >= 0x20020000 && sp <= 0x2002FFFF) || // SRAM2
+          (sp >= 0x200B0000 && sp <= 0x200BFFFF)))  // CCM
+    {
+        return 0;
+    }
+
+    /* An image linked for the other slot would run the wrong copy */
+    return ((reset >= address) && (reset < (address + SlotGetSize(slot)))) ? 1U : 0U;
+}
+
+/**
+ * @brief  Check every byte of a slot, or find that this was done before
+ * @param  slot: SLOT_A or SLOT_B
+ * @param  mayRead: 0 to only look for the marker, nothing is read or written
+ *         then and an image without one counts as not verified
+ * @retval 1 if the image is intact or carries no header to check against
+ */
+static uint8_t SlotIsVerified(uint32_t slot, uint32_t mayRead)
+{
+    const ImageHeader *header = ImageGetHeader(SlotGetAddress(slot));
+    const uint32_t cycles = DWT->CYCCNT;
+    uint8_t verified = 1;
+
+    slotVerifyCold = 0;
+    if ((header != NULL) && (ResumeIsSlotVerified(slot, header->HeaderCrc) == 0U))
+    {
+        if (mayRead == 0U)
+        {
+            return 0;
+        }
+        slotVerifyCold = 1;
+        verified = (ImageVerify(header) != 0U) ? 1U : 0U;
+        if (verified != 0U)
+        {
+            (void)ResumeSetSlotVerified(slot, header->HeaderCrc);
+        }
+    }
+    slotVerifyTime = (DWT->CYCCNT - cycles) / (SystemCoreClock / 1000000U);
+
+    return verified;
+}
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief  Start address of a slot
+ * @param  slot: SLOT_A or SLOT_B
+ * @retval Flash address
+ */
+uint32_t SlotGetAddress(uint32_t slot)
+{
+    return (slot == SLOT_B) ? SLOT_B_ADDRESS : SLOT_A_ADDRESS;
+}
+
+/**
+ * @brief  Size of a slot
+ * @param  slot: SLOT_A or SLOT_B
+ * @retval Size in bytes
+ */
+uint32_t SlotGetSize(uint32_t slot)
+{
+    return (slot == SLOT_B) ? SLOT_B_SIZE : SLOT_A_SIZE;
+}
+
+/**
+ * @brief  Vector table of the application in a slot
+ * @param  slot: SLOT_A or SLOT_B
+ * @retval Address behind the header, or the slot start for a plain binary
+ */
+uint32_t SlotGetImageAddress(uint32_t slot)
+{
+    const ImageHeader *header = ImageGetHeader(SlotGetAddress(slot));
+
+    return (header != NULL) ? header->LoadAddress : SlotGetAddress(slot);
+}
+
+/**
+ * @brief  Version of the application in a slot
+ * @param  slot: SLOT_A or SLOT_B
+ * @retval Version from the header, 0 for a plain binary
+ */
+uint32_t SlotGetVersion(uint32_t slot)
+{
+    const ImageHeader *header = ImageGetHeader(SlotGetAddress(slot));
+
+    return (header != NULL) ? header->Version : 0U;
+}
+
+/**
+ * @brief  Flags of the application in a slot
+ * @param  slot: SLOT_A or SLOT_B
+ * @retval IMAGE_FLAG_xxx from the header, 0 for a plain binary
+ */
+uint32_t SlotGetFlags(uint32_t slot)
+{
+    const ImageHeader *header = ImageGetHeader(SlotGetAddress(slot));
+
+    return (header != NULL) ? header->Flags : 0U;
+}
+
+/**
+ * @brief  Check that a slot holds a whole image, in constant time
+ * @param  slot: SLOT_A or SLOT_B
+ * @retval 1 if the header and trailer are intact, or for a plain binary if
+ *         its vector table looks right
+ */
+uint8_t SlotIsComplete(uint32_t slot)
+{
+    if (ImageGetHeader(SlotGetAddress(slot)) != NULL)
+    {
+        return (ImageIsComplete(SlotGetAddress(slot), SlotGetSize(slot)) != 0U) ? 1U : 0U;
+    }
+
+    return SlotHasVectors(slot);
+}
+
+/**
+ * @brief  Slot selected for booting
+ * @retval SLOT_A or SLOT_B
+ */
+uint32_t SlotGetActive(void)
+{
+    return ResumeGetActiveSlot();
+}
+
+/**
+ * @brief  Slot a download is written to, the one that is not active
+ * @retval SLOT_A or SLOT_B
+ */
+uint32_t SlotGetTarget(void)
+{
+    return (SlotGetActive() == SLOT_A) ? SLOT_B : SLOT_A;
+}
+
+/**
+ * @brief  Check whether a slot can be booted
+ * @param  slot: SLOT_A or SLOT_B
+ * @retval 1 if it holds a complete, intact image linked for its address
+ */
+uint8_t SlotIsBootable(uint32_t slot)
+{
+    return (((ResumeGetValidSlots() & (1UL << slot)) != 0U) && (SlotIsComplete(slot) != 0U) &&
+            (SlotIsVerified(slot, 1) != 0U))
+               ? 1U
+               : 0U;
+}
+
+/**
+ * @brief  Check whether a slot can be booted from what is on record
+ * @note   For the fast path before HAL_Init: the image is not read and the
+ *         journal not written. A slot whose full check is not recorded yet
+ *         counts as not bootable, SlotIsBootable() checks it once the clocks
+ *         run.
+ * @param  slot: SLOT_A or SLOT_B
+ * @retval 1 if it holds a complete image that was verified before
+ */
+uint8_t SlotIsBootableFast(uint32_t slot)
+{
+    return (((ResumeGetValidSlots() & (1UL << slot)) != 0U) && (SlotIsComplete(slot) != 0U) &&
+            (SlotIsVerified(slot, 0) != 0U))
+               ? 1U
+               : 0U;
+}
+
+/**
+ * @brief  Time the last full image check took
+ * @param  cold: set to 1 if the image was read, 0 if its marker was found
+ * @retval Microseconds
+ */
+uint32_t SlotGetVerifyTime(uint32_t *cold)
+{
+    *cold = slotVerifyCold;
+
+    return slotVerifyTime;
+}
+
+/**
+ * @brief  Choose the slot to boot
+ * @note   Falls back to the other slot if the active one cannot be booted,
+ *         and makes that choice permanent.
+ * @retval SLOT_A, SLOT_B, or SLOT_NONE if neither holds a usable image
+ */
+uint32_t SlotGetBootSlot(void)
+{
+    const uint32_t active = SlotGetActive();
+    const uint32_t other = (active == SLOT_A) ? SLOT_B : SLOT_A;
+
+    if (SlotIsBootable(active) != 0U)
+    {
+        return active;
+    }
+    if (SlotIsBootable(other) != 0U)
+    {
+        (void)ResumeSetActiveSlot(other);
+        return other;
+    }
+
+    return SLOT_NONE;
+}
+
+/**
+ * @brief  CRC of the image in a slot, recorded when it was activated
+ * @param  slot: SLOT_A or SLOT_B
+ * @retval CRC-32, 0 if unknown
+ */
+uint32_t SlotGetCrc(uint32_t slot)
+{
+    return ResumeGetSlotCrc(slot);
+}
+
+/**
+ * @brief  Mark a freshly downloaded slot complete and boot it from now on
+ * @note   A packed image is checked in full here and gets its verified
+ *         marker, and the CRC from its header is kept in the journal so later
+ *         boots can report it without reading the image again. For a plain
+ *         binary the CRC of the whole file is computed and kept.
+ * @param  slot: SLOT_A or SLOT_B
+ * @param  size: file size in bytes
+ * @retval SLOT_OK, SLOT_NOT_BOOTABLE if the image is incomplete, corrupt or
+ *         not linked for the slot, or SLOT_WRITE_ERROR
+ */
+uint32_t SlotActivate(uint32_t slot, uint32_t size)
+{
+    const ImageHeader *header = ImageGetHeader(SlotGetAddress(slot));
+    uint32_t crc;
+
+    if (header != NULL)
+    {
+        if ((ImageIsComplete(SlotGetAddress(slot), SlotGetSize(slot)) == 0U) || (SlotIsVerified(slot, 1) == 0U))
+        {
+            return SLOT_NOT_BOOTABLE;
+        }
+        crc = header->Crc;
+    }
+    else
+    {
+        if ((SlotHasVectors(slot) == 0U) || (size > SlotGetSize(slot)))
+        {
+            return SLOT_NOT_BOOTABLE;
+        }
+        crc = Crc32Update(0, (const uint8_t *)SlotGetAddress(slot), size);
+    }
+
+    if ((ResumeSetSlotValid(slot, crc) != FLASHIF_OK) || (ResumeSetActiveSlot(slot) != FLASHIF_OK))
+    {
+        return SLOT_WRITE_ERROR;
+    }
+
+    return SLOT_OK;
+}
+
+/**
+ * @brief  Boot the previous image again
+ * @retval SLOT_OK, SLOT_NOT_BOOTABLE if the other slot holds no complete
+ *         image, or SLOT_WRITE_ERROR
+ */
+uint32_t SlotRollback(void)
+{
+    const uint32_t other = SlotGetTarget();
+
+    if (SlotIsBootable(other) == 0U)
+    {
+        return SLOT_NOT_BOOTABLE;
+    }
+
+    return (ResumeSetActiveSlot(other) == FLASHIF_OK) ? SLOT_OK : SLOT_WRITE_ERROR;
+}
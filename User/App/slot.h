@@ -0,0 +1,74 @@
+/* USER CODE BEGIN Header */
+/**
+ ******************************************************************************
+ * @file           : slot.h
+ * @brief          : A/B application slots
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2025 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+/* USER CODE END Header */
+
+#ifndef __SLOT_H__
+#define __SLOT_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "flash_if.h"
+
+/* Exported constants --------------------------------------------------------*/
+// 两个应用程序槽，各占一个Flash Bank，镜像需按所在槽的地址链接（带镜像头时为槽地址+0x200）
+#define SLOT_A ((uint32_t)0)
+#define SLOT_B ((uint32_t)1)
+#define SLOT_COUNT ((uint32_t)2)
+#define SLOT_NONE ((uint32_t)0xFFFFFFFF)
+
+/* Slot A: sectors 2-11, Flash bank 1, the address of the single slot layout */
+#define SLOT_A_ADDRESS APPLICATION_ADDRESS
+#define SLOT_A_SIZE (ADDR_FLASH_SECTOR_12 - APPLICATION_ADDRESS)
+/* Slot B: sectors 12-21, Flash bank 2 */
+#define SLOT_B_ADDRESS ADDR_FLASH_SECTOR_12
+#define SLOT_B_SIZE (USER_FLASH_END_ADDRESS + 1U - ADDR_FLASH_SECTOR_12)
+
+/* Error code */
+enum
+{
+    SLOT_OK = 0,
+    SLOT_NOT_BOOTABLE,
+    SLOT_WRITE_ERROR
+};
+
+    /* Exported functions ------------------------------------------------------- */
+    uint32_t SlotGetAddress(uint32_t slot);
+    uint32_t SlotGetSize(uint32_t slot);
+    uint32_t SlotGetImageAddress(uint32_t slot);
+    uint32_t SlotGetVersion(uint32_t slot);
+    uint32_t SlotGetFlags(uint32_t slot);
+    uint8_t SlotIsComplete(uint32_t slot);
+    uint32_t SlotGetActive(void);
+    uint32_t SlotGetTarget(void);
+    uint8_t SlotIsBootable(uint32_t slot);
+    uint8_t SlotIsBootableFast(uint32_t slot);
+    uint32_t SlotGetVerifyTime(uint32_t *cold);
+    uint32_t SlotGetBootSlot(void);
+    uint32_t SlotGetCrc(uint32_t slot);
+    uint32_t SlotActivate(uint32_t slot, uint32_t size);
+    uint32_t SlotRollback(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SLOT_H__ */
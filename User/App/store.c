@@ -0,0 +1,379 @@
+/* USER CODE BEGIN Header */
+/**
+ ******************************************************************************
+ * @file           : store.c
+ * @brief          : Append-only store for bootloader flags and counters
+ *
+ *          Every update appends one 32-bit record, so it costs a single word
+ *          program and no erase. Reading replays the records and the last
+ *          one of each key wins. Only when the area is full it is erased and
+ *          the current values are written back, which spreads the wear of
+ *          thousands of updates over one erase.
+ *
+ *          Record: key (31:24), value (23:8), check (7:0). An erased word ends
+ *          the log; a word torn by a reset fails its check and is skipped.
+ *
+ *          The area is the lower half of sector 23. The transfer records of
+ *          telemetry.c follow it, up to the legacy flag at
+ *          BOOTLOADER_FLAG_ADDRESS, which applications built against the old
+ *          bootloader_flag.c may still write. The compaction erases the whole
+ *          sector, so it keeps both: the store records, the legacy flag
+ *          folded into STORE_KEY_UPGRADE, and the latest transfer records.
+ *          These words are first copied into the journal of resume.c and only
+ *          dropped from there once the sector is written back. A reset in
+ *          between leaves the copy, which the next read of the store writes
+ *          back before anything else.
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2025 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+/* USER CODE END Header */
+
+/* Includes ------------------------------------------------------------------*/
+#include "store.h"
+#include "bootloader_flag.h"
+#include "flash_if.h"
+#include "resume.h"
+#include "telemetry.h"
+
+#include <stddef.h>
+
+/* Private define ------------------------------------------------------------*/
+#define STORE_ADDRESS ADDR_FLASH_SECTOR_23
+#define STORE_END TELEMETRY_ADDRESS
+
+#define STORE_BLANK 0xFFFFFFFFUL
+/* Words the compaction writes back: a record per key and the transfer records */
+#define STORE_COPY_MAX ((STORE_KEY_COUNT - 1U) + (TELEMETRY_KEEP * (sizeof(TelemetryRecord) / sizeof(uint32_t))))
+
+/* Private macro -------------------------------------------------------------*/
+#define STORE_CHECK(key, value) ((uint8_t)((key) ^ ((value) >> 8) ^ (value) ^ 0xA5U))
+#define STORE_RECORD(key, value)                                                                                       \
+    (((uint32_t)(key) << 24) | ((uint32_t)(value) << 8) | STORE_CHECK((key), (value)))
+
+/* Private function prototypes -----------------------------------------------*/
+static uint32_t StoreFlashProgram(uint32_t address, uint32_t word);
+static uint32_t StoreFlashErase(void);
+static uint32_t StoreFlashBackup(const StoreWord *words, uint32_t count);
+static uint32_t StoreFlashRecover(StoreWord *words, uint32_t max);
+static uint32_t StoreRewrite(uint32_t count);
+static void StoreScan(void);
+
+/* Private variables ---------------------------------------------------------*/
+static const StoreArea storeFlash = {STORE_ADDRESS,   STORE_END,        StoreFlashProgram,
+                                     StoreFlashErase, StoreFlashBackup, StoreFlashRecover};
+
+static const StoreArea *storeArea = &storeFlash;
+static uint32_t storeScanned;
+static uint32_t storeNext;    /* Address of the first free record */
+static uint32_t storePresent; /* Bit per key that has a record */
+static uint16_t aStoreValue[STORE_KEY_COUNT];
+static StoreWord aStoreCopy[STORE_COPY_MAX];
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Program one record into sector 23
+ * @param  address: record address
+ * @param  word: record
+ * @retval STORE_OK if written
+ */
+static uint32_t StoreFlashProgram(uint32_t address, uint32_t word)
+{
+    FlashIfInit();
+
+    return (HAL_FLASH_Program(TYPEPROGRAM_WORD, address, word) == HAL_OK) ? STORE_OK : STORE_WRITE_ERROR;
+}
+
+/**
+ * @brief  Erase sector 23
+ * @retval STORE_OK if erased
+ */
+static uint32_t StoreFlashErase(void)
+{
+    FLASH_EraseInitTypeDef eraseInit;
+    uint32_t sectorError;
+
+    FlashIfInit();
+    eraseInit.TypeErase = TYPEERASE_SECTORS;
+    eraseInit.Sector = BOOTLOADER_FLAG_SECTOR;
+    eraseInit.NbSectors = 1;
+    eraseInit.VoltageRange = VOLTAGE_RANGE_3;
+
+    return (HAL_FLASHEx_Erase(&eraseInit, &sectorError) == HAL_OK) ? STORE_OK : STORE_ERASE_ERROR;
+}
+
+/**
+ * @brief  Copy the words written back into the journal of sector 22
+ * @param  words: words with their address in sector 23
+ * @param  count: number of words, 0 to drop the copy
+ * @retval STORE_OK once the copy is sealed or dropped
+ */
+static uint32_t StoreFlashBackup(const StoreWord *words, uint32_t count)
+{
+    uint32_t i;
+
+    if (count == 0U)
+    {
+        return (ResumeCopyEnd(0) == FLASHIF_OK) ? STORE_OK : STORE_WRITE_ERROR;
+    }
+
+    if (ResumeCopyBegin(count) != FLASHIF_OK)
+    {
+        return STORE_WRITE_ERROR;
+    }
+    for (i = 0; i < count; i++)
+    {
+        if (ResumeCopyWord((words[i].Address - STORE_ADDRESS) / 4U, words[i].Word) != FLASHIF_OK)
+        {
+            return STORE_WRITE_ERROR;
+        }
+    }
+
+    return (ResumeCopyEnd(count) == FLASHIF_OK) ? STORE_OK : STORE_WRITE_ERROR;
+}
+
+/**
+ * @brief  Read back a copy sealed in the journal and not dropped
+ * @param  words: filled with the words and their address
+ * @param  max: room in words
+ * @retval Number of words, 0 if there is no copy
+ */
+static uint32_t StoreFlashRecover(StoreWord *words, uint32_t max)
+{
+    uint32_t i, index, word, count;
+
+    count = ResumeGetCopy(0, &index, &word);
+    if (count > max)
+    {
+        return 0;
+    }
+    for (i = 0; i < count; i++)
+    {
+        (void)ResumeGetCopy(i, &index, &word);
+        words[i].Address = STORE_ADDRESS + (index * 4U);
+        words[i].Word = word;
+    }
+
+    return count;
+}
+
+/**
+ * @brief  Erase the area and write the copied words back
+ * @param  count: words in aStoreCopy, already copied by the Backup hook
+ * @retval STORE_OK once written back and the copy dropped
+ */
+static uint32_t StoreRewrite(uint32_t count)
+{
+    uint32_t i;
+
+    if (storeArea->Erase() != STORE_OK)
+    {
+        return STORE_ERASE_ERROR;
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        if (storeArea->Program(aStoreCopy[i].Address, aStoreCopy[i].Word) != STORE_OK)
+        {
+            return STORE_WRITE_ERROR;
+        }
+    }
+
+    return storeArea->Backup(NULL, 0);
+}
+
+/**
+ * @brief  Replay the log into the value cache
+ * @note   Writes the area back first if a reset cut a compaction short.
+ * @retval None
+ */
+static void StoreScan(void)
+{
+    uint32_t address, record, count;
+    uint8_t key;
+    uint16_t value;
+
+    count = storeArea->Recover(aStoreCopy, STORE_COPY_MAX);
+    if (count != 0U)
+    {
+        /* Kept for the next boot if this fails too */
+        (void)StoreRewrite(count);
+    }
+
+    storePresent = 0;
+    for (address = storeArea->Start; address < storeArea->End; address += 4U)
+    {
+        record = *(__IO uint32_t *)address;
+        if (record == STORE_BLANK)
+        {
+            break;
+        }
+
+        key = (uint8_t)(record >> 24);
+        value = (uint16_t)(record >> 8);
+        if ((key != 0U) && (key < STORE_KEY_COUNT) && ((uint8_t)record == STORE_CHECK(key, value)))
+        {
+            aStoreValue[key] = value;
+            storePresent |= 1UL << key;
+        }
+    }
+
+    storeNext = address;
+    storeScanned = 1;
+}
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief  Select the Flash the store lives in
+ * @note   Only needed to run the store on an emulated Flash, the default is
+ *         sector 23.
+ * @param  area: Flash area, NULL for sector 23
+ * @retval None
+ */
+void StoreInit(const StoreArea *area)
+{
+    storeArea = (area != NULL) ? area : &storeFlash;
+    StoreScan();
+}
+
+/**
+ * @brief  Read a value
+ * @param  key: STORE_KEY_xxx
+ * @param  defaultValue: returned when the key was never written
+ * @retval Last value written
+ */
+uint16_t StoreGet(uint8_t key, uint16_t defaultValue)
+{
+    if (storeScanned == 0U)
+    {
+        StoreScan();
+    }
+
+    return ((key < STORE_KEY_COUNT) && ((storePresent & (1UL << key)) != 0U)) ? aStoreValue[key] : defaultValue;
+}
+
+/**
+ * @brief  Write a value
+ * @note   One word program, nothing is written if the value is unchanged.
+ * @param  key: STORE_KEY_xxx
+ * @param  value: new value
+ * @retval STORE_OK, or an error code
+ */
+uint32_t StoreSet(uint8_t key, uint16_t value)
+{
+    if ((key == 0U) || (key >= STORE_KEY_COUNT))
+    {
+        return STORE_WRITE_ERROR;
+    }
+    if (storeScanned == 0U)
+    {
+        StoreScan();
+    }
+    if (((storePresent & (1UL << key)) != 0U) && (aStoreValue[key] == value))
+    {
+        return STORE_OK;
+    }
+
+    aStoreValue[key] = value;
+    storePresent |= 1UL << key;
+
+    /* The compaction writes the new value along with the others */
+    if (storeNext >= storeArea->End)
+    {
+        return StoreCompact();
+    }
+
+    /* Skip the record even if it failed, its word is no longer blank */
+    storeNext += 4U;
+
+    return storeArea->Program(storeNext - 4U, STORE_RECORD(key, value));
+}
+
+/**
+ * @brief  Add one to a counter
+ * @param  key: STORE_KEY_xxx
+ * @retval STORE_OK, or an error code
+ */
+uint32_t StoreIncrement(uint8_t key)
+{
+    return StoreSet(key, (uint16_t)(StoreGet(key, 0) + 1U));
+}
+
+/**
+ * @brief  Records left before the next compaction
+ * @retval Number of free records
+ */
+uint32_t StoreGetFree(void)
+{
+    if (storeScanned == 0U)
+    {
+        StoreScan();
+    }
+
+    return (storeArea->End - storeNext) / 4U;
+}
+
+/**
+ * @brief  Erase the full area and write the current values back
+ * @note   Done when the store is full, and by telemetry.c when its records
+ *         fill the rest of sector 23. The words written back are copied by
+ *         the Backup hook first, UPGRADE the first of them, so that a reset
+ *         after the erase loses nothing.
+ * @retval STORE_OK, or an error if the area could not be rewritten
+ */
+uint32_t StoreCompact(void)
+{
+    const BootloaderFlag *legacy = (const BootloaderFlag *)BOOTLOADER_FLAG_ADDRESS;
+    uint32_t key, records, count = 0, status;
+
+    if (storeScanned == 0U)
+    {
+        StoreScan();
+    }
+
+    /* The erase also takes the legacy flag of an old application with it */
+    if ((storeArea == &storeFlash) && (legacy->MagicValue == BOOTLOADER_FLAG_MAGIC) &&
+        (legacy->BootFlag == BOOTLOADER_FLAG_UPGRADE))
+    {
+        aStoreValue[STORE_KEY_UPGRADE] = 1;
+        storePresent |= 1UL << STORE_KEY_UPGRADE;
+    }
+
+    for (key = 1; key < STORE_KEY_COUNT; key++)
+    {
+        if ((storePresent & (1UL << key)) != 0U)
+        {
+            aStoreCopy[count].Address = storeArea->Start + (count * 4U);
+            aStoreCopy[count].Word = STORE_RECORD(key, aStoreValue[key]);
+            count++;
+        }
+    }
+    records = count;
+
+    /* The transfer records share the sector */
+    if (storeArea == &storeFlash)
+    {
+        count += TelemetryHold(&aStoreCopy[count], STORE_COPY_MAX - count);
+    }
+
+    status = storeArea->Backup(aStoreCopy, count);
+    if (status == STORE_OK)
+    {
+        status = StoreRewrite(count);
+    }
+
+    /* Compact again on the next update if anything is missing */
+    storeNext = (status == STORE_OK) ? (storeArea->Start + (records * 4U)) : storeArea->End;
+
+    return status;
+}
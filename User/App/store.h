@@ -0,0 +1,79 @@
+/* USER CODE BEGIN Header */
+/**
+ ******************************************************************************
+ * @file           : store.h
+ * @brief          : Append-only store for bootloader flags and counters
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2025 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+/* USER CODE END Header */
+
+#ifndef __STORE_H__
+#define __STORE_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+/* Keys, 1 to STORE_KEY_COUNT - 1 */
+#define STORE_KEY_UPGRADE ((uint8_t)1)   /* Enter the menu on the next boot */
+#define STORE_KEY_UPDATES ((uint8_t)2)   /* Images activated */
+#define STORE_KEY_ROLLBACKS ((uint8_t)3) /* Rollbacks from the menu */
+#define STORE_KEY_COUNT ((uint8_t)16)
+
+/* Error code */
+enum
+{
+    STORE_OK = 0,
+    STORE_WRITE_ERROR,
+    STORE_ERASE_ERROR
+};
+
+    /* Exported types ------------------------------------------------------------*/
+    /* A word the compaction writes back after the erase */
+    typedef struct
+    {
+        uint32_t Address;
+        uint32_t Word;
+    } StoreWord;
+
+    /* Flash the store lives in, replaceable by an emulation on the host */
+    typedef struct
+    {
+        uint32_t Start;                                       /* First record, word aligned */
+        uint32_t End;                                         /* Address after the last record */
+        uint32_t (*Program)(uint32_t address, uint32_t word); /* STORE_OK if the word was written */
+        uint32_t (*Erase)(void);                              /* Erase Start to End, STORE_OK if done */
+        /* Keep a copy of the words elsewhere until the area is written back,
+           count 0 drops it. STORE_OK once the copy is complete. */
+        uint32_t (*Backup)(const StoreWord *words, uint32_t count);
+        uint32_t (*Recover)(StoreWord *words, uint32_t max); /* Copy not dropped, number of words */
+    } StoreArea;
+
+    /* Exported functions ------------------------------------------------------- */
+    void StoreInit(const StoreArea *area);
+    uint16_t StoreGet(uint8_t key, uint16_t defaultValue);
+    uint32_t StoreSet(uint8_t key, uint16_t value);
+    uint32_t StoreIncrement(uint8_t key);
+    uint32_t StoreGetFree(void);
+    uint32_t StoreCompact(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __STORE_H__ */
@@ -0,0 +1,260 @@
+/* USER CODE BEGIN Header */
+/**
+ ******************************************************************************
+ * @file           : telemetry.c
+ * @brief          : Per-session transfer records kept in Flash
+ *
+ *          The receiver appends one record per download session. Appending
+ *          programs eight words and never erases; the check word goes last so
+ *          a record torn by a reset fails its check and is skipped. When the
+ *          area is full, sector 23 is erased by the store compaction, which
+ *          writes the latest TELEMETRY_KEEP records back with its own values.
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2025 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+/* USER CODE END Header */
+
+/* Includes ------------------------------------------------------------------*/
+#include "telemetry.h"
+#include "flash_if.h"
+#include "store.h"
+
+#include <stddef.h>
+
+/* Private define ------------------------------------------------------------*/
+#define TELEMETRY_WORDS (sizeof(TelemetryRecord) / sizeof(uint32_t))
+#define TELEMETRY_BLANK 0xFFFFFFFFUL
+
+/* Private function prototypes -----------------------------------------------*/
+static uint32_t TelemetryIsBlank(uint32_t address);
+static uint32_t TelemetryProgram(uint32_t address, const TelemetryRecord *record);
+static void TelemetryScan(void);
+
+/* Private variables ---------------------------------------------------------*/
+static uint32_t telemetryScanned;
+static uint32_t telemetryNext;     /* Address of the first free record */
+static uint32_t telemetryCount;    /* Valid records */
+static uint32_t telemetrySequence; /* Of the next record */
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Check whether a record slot was never written
+ * @note   A torn record may have any word still erased, even the check word.
+ * @param  address: record address
+ * @retval 1 if all words are erased
+ */
+static uint32_t TelemetryIsBlank(uint32_t address)
+{
+    uint32_t i;
+
+    for (i = 0; i < TELEMETRY_WORDS; i++)
+    {
+        if (*(__IO uint32_t *)(address + (i * 4U)) != TELEMETRY_BLANK)
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * @brief  Program one record into sector 23
+ * @param  address: record address
+ * @param  record: record with its check word filled in
+ * @retval STORE_OK if written
+ */
+static uint32_t TelemetryProgram(uint32_t address, const TelemetryRecord *record)
+{
+    const uint32_t *word = (const uint32_t *)record;
+    uint32_t i;
+
+    FlashIfInit();
+
+    /* The check word last, it makes the record valid */
+    for (i = 1; i < TELEMETRY_WORDS; i++)
+    {
+        if (HAL_FLASH_Program(TYPEPROGRAM_WORD, address + (i * 4U), word[i]) != HAL_OK)
+        {
+            return STORE_WRITE_ERROR;
+        }
+    }
+
+    return (HAL_FLASH_Program(TYPEPROGRAM_WORD, address, word[0]) == HAL_OK) ? STORE_OK : STORE_WRITE_ERROR;
+}
+
+/**
+ * @brief  Find the end of the records and the next sequence number
+ * @retval None
+ */
+static void TelemetryScan(void)
+{
+    const TelemetryRecord *record;
+    uint32_t address;
+
+    telemetryCount = 0;
+    telemetrySequence = 0;
+    for (address = TELEMETRY_ADDRESS; address < TELEMETRY_END; address += sizeof(TelemetryRecord))
+    {
+        if (TelemetryIsBlank(address) != 0U)
+        {
+            break;
+        }
+
+        record = (const TelemetryRecord *)address;
+        if (TelemetryRecordIsValid(record) != 0U)
+        {
+            telemetrySequence = record->Sequence + 1U;
+            telemetryCount++;
+        }
+    }
+
+    telemetryNext = address;
+    telemetryScanned = 1;
+}
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief  Append the record of a session
+ * @note   Blocks for the erase of sector 23 when the area is full.
+ * @param  record: session figures, Sequence and Check are filled in here
+ * @retval STORE_OK, or an error code
+ */
+uint32_t TelemetryAppend(TelemetryRecord *record)
+{
+    uint32_t status = STORE_OK;
+
+    if (telemetryScanned == 0U)
+    {
+        TelemetryScan();
+    }
+
+    record->Sequence = telemetrySequence;
+    record->Check = TelemetryRecordCheck(record);
+
+    if ((telemetryNext + sizeof(TelemetryRecord)) > TELEMETRY_END)
+    {
+        status = StoreCompact();
+        if (telemetryScanned == 0U)
+        {
+            TelemetryScan();
+        }
+    }
+    if ((status == STORE_OK) && ((telemetryNext + sizeof(TelemetryRecord)) > TELEMETRY_END))
+    {
+        /* The store lives elsewhere and did not erase sector 23 */
+        status = STORE_WRITE_ERROR;
+    }
+
+    if (status == STORE_OK)
+    {
+        /* Skip the record even if it failed, its words are no longer blank */
+        telemetryNext += sizeof(TelemetryRecord);
+        telemetrySequence++;
+        status = TelemetryProgram(telemetryNext - sizeof(TelemetryRecord), record);
+        if (status == STORE_OK)
+        {
+            telemetryCount++;
+        }
+    }
+
+    return status;
+}
+
+/**
+ * @brief  Number of records that can be read
+ * @retval Valid records in the area
+ */
+uint32_t TelemetryGetCount(void)
+{
+    if (telemetryScanned == 0U)
+    {
+        TelemetryScan();
+    }
+
+    return telemetryCount;
+}
+
+/**
+ * @brief  Read a record
+ * @param  index: 0 for the latest session, up to TelemetryGetCount() - 1
+ * @retval Record in Flash, NULL if there are not that many
+ */
+const TelemetryRecord *TelemetryGet(uint32_t index)
+{
+    const TelemetryRecord *record;
+    uint32_t address;
+
+    if (telemetryScanned == 0U)
+    {
+        TelemetryScan();
+    }
+
+    for (address = telemetryNext; address > TELEMETRY_ADDRESS;)
+    {
+        address -= sizeof(TelemetryRecord);
+        record = (const TelemetryRecord *)address;
+        if (TelemetryRecordIsValid(record) != 0U)
+        {
+            if (index == 0U)
+            {
+                return record;
+            }
+            index--;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief  List the words of the latest records before sector 23 is erased
+ * @note   Called by the store compaction, which writes them back to the
+ *         start of the area in the order listed, each check word last.
+ * @param  words: filled with the words and the addresses they go back to
+ * @param  max: room in words, at least TELEMETRY_KEEP records
+ * @retval Number of words listed
+ */
+uint32_t TelemetryHold(StoreWord *words, uint32_t max)
+{
+    const uint32_t *record;
+    uint32_t held, index, i, count = 0;
+
+    held = TelemetryGetCount();
+    if (held > TELEMETRY_KEEP)
+    {
+        held = TELEMETRY_KEEP;
+    }
+    if (held > (max / TELEMETRY_WORDS))
+    {
+        held = max / TELEMETRY_WORDS;
+    }
+
+    /* Oldest first, the sequence numbers go on from the newest */
+    for (index = 0; index < held; index++)
+    {
+        record = (const uint32_t *)TelemetryGet(held - 1U - index);
+        for (i = 1; i <= TELEMETRY_WORDS; i++)
+        {
+            words[count].Address = TELEMETRY_ADDRESS + (index * sizeof(TelemetryRecord)) + ((i % TELEMETRY_WORDS) * 4U);
+            words[count].Word = record[i % TELEMETRY_WORDS];
+            count++;
+        }
+    }
+
+    /* Scan again once the sector is written back */
+    telemetryScanned = 0;
+
+    return count;
+}
@@ -0,0 +1,116 @@
+/* USER CODE BEGIN Header */
+/**
+ ******************************************************************************
+ * @file           : telemetry.h
+ * @brief          : Per-session transfer records kept in Flash
+ *
+ *          Readable by the application: walk the records from
+ *          TELEMETRY_ADDRESS to TELEMETRY_END in steps of
+ *          sizeof(TelemetryRecord) and skip those that fail
+ *          TelemetryRecordIsValid(). They are in the order they were written,
+ *          the last valid one is the latest session.
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2025 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+/* USER CODE END Header */
+
+#ifndef __TELEMETRY_H__
+#define __TELEMETRY_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "store.h"
+
+#include <stdint.h>
+
+/* Exported constants --------------------------------------------------------*/
+/* Upper half of sector 23, up to the legacy flag at BOOTLOADER_FLAG_ADDRESS.
+   The store (store.c) has the lower half. */
+#define TELEMETRY_ADDRESS ((uint32_t)0x081F0000)
+#define TELEMETRY_END ((uint32_t)0x081FFF00)
+#define TELEMETRY_MAGIC ((uint32_t)0x4D4C4554) /* "TELM" */
+
+/* Latest records written back when sector 23 is erased */
+#define TELEMETRY_KEEP ((uint32_t)16)
+
+/* TelemetryRecord.Flags */
+#define TELEMETRY_FLAG_STREAMING ((uint8_t)0x01) /* YMODEM-G, no ACKs and no retransmission */
+#define TELEMETRY_FLAG_XBLOCK ((uint8_t)0x02)    /* 4K/8K blocks agreed in block 0 */
+#define TELEMETRY_FLAG_RESUMED ((uint8_t)0x04)   /* Continued an interrupted transfer */
+#define TELEMETRY_FLAG_OVERRUN ((uint8_t)0x08)   /* The UART receive ring overflowed */
+
+    /* Exported types ------------------------------------------------------------*/
+    /* One download session, 8 words */
+    typedef struct
+    {
+        uint32_t Check;          /* TELEMETRY_MAGIC ^ ~sum of the other words, programmed last */
+        uint32_t Sequence;       /* Session number, kept across erases */
+        uint8_t Status;          /* COM_StatusTypeDef of the receiver, 0 for success */
+        uint8_t Flags;           /* TELEMETRY_FLAG_xxx */
+        uint16_t Baud;           /* Line rate in units of 100 baud */
+        uint32_t Size;           /* File size announced in block 0 */
+        uint32_t Time;           /* Milliseconds from block 0 to the end of the session */
+        uint16_t Naks;           /* Blocks asked for again, NAK or poll */
+        uint16_t Timeouts;       /* Waits for the sender that expired */
+        uint16_t CrcErrors;      /* Damaged frames: CRC, header or block number complement */
+        uint16_t SequenceErrors; /* Blocks with an unexpected number */
+        uint16_t EraseTime;      /* Milliseconds the sectors took to erase, saturated */
+        uint16_t ProgramTime;    /* Milliseconds spent programming, saturated */
+    } TelemetryRecord;
+
+    /* Exported functions ------------------------------------------------------- */
+
+    /**
+     * @brief  Check word of a record
+     * @param  record: record
+     * @retval TELEMETRY_MAGIC xor the complement of the sum of the other words
+     */
+    static inline uint32_t TelemetryRecordCheck(const TelemetryRecord *record)
+    {
+        const uint32_t *word = (const uint32_t *)record;
+        uint32_t sum = 0;
+        uint32_t i;
+
+        for (i = 1; i < (sizeof(TelemetryRecord) / sizeof(uint32_t)); i++)
+        {
+            sum += word[i];
+        }
+
+        return TELEMETRY_MAGIC ^ ~sum;
+    }
+
+    /**
+     * @brief  Check a record
+     * @note   An erased record and one torn by a reset both fail.
+     * @param  record: record in the Flash ring
+     * @retval 1 if the record is complete
+     */
+    static inline uint32_t TelemetryRecordIsValid(const TelemetryRecord *record)
+    {
+        return (record->Check == TelemetryRecordCheck(record)) ? 1U : 0U;
+    }
+
+    /* Bootloader side, telemetry.c */
+    uint32_t TelemetryAppend(TelemetryRecord *record);
+    uint32_t TelemetryGetCount(void);
+    const TelemetryRecord *TelemetryGet(uint32_t index);
+    uint32_t TelemetryHold(StoreWord *words, uint32_t max);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __TELEMETRY_H__ */
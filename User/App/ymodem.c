@@ -24,24 +24,43 @@
 /* Includes ------------------------------------------------------------------*/
 #include "ymodem.h"
 #include "common.h"
+#include "crc16.h"
+#include "crc32.h"
 #include "flash_if.h"
 #include "menu.h"
+#include "profile.h"
+#include "resume.h"
+#include "serial_rx.h"
+#include "slot.h"
+#include "telemetry.h"
+#include <string.h>
 
 /* Private typedef -----------------------------------------------------------*/
 /* Private define ------------------------------------------------------------*/
 #define CRC16_F /* activate the CRC16 integrity */
+/* One buffer is being received while the others wait in the flash queue */
+#define YMODEM_PACKET_BUFFERS (FLASHIF_QUEUE_DEPTH + 1U)
+/* Rounded up so that the data of every buffer stays 32bit aligned */
+#if (YMODEM_XBLOCK_SIZE > 1024U)
+#define YMODEM_PACKET_BUFFER_SIZE ((YMODEM_XBLOCK_SIZE + PACKET_DATA_INDEX + PACKET_XTRAILER_SIZE + 3U) & ~3U)
+#else
+#define YMODEM_PACKET_BUFFER_SIZE ((PACKET_1K_SIZE + PACKET_DATA_INDEX + PACKET_TRAILER_SIZE + 3U) & ~3U)
+#endif
 /* Private macro -------------------------------------------------------------*/
 /* Private variables ---------------------------------------------------------*/
 __IO uint32_t flashDestination;
 /* @note ATTENTION - please keep this variable 32bit aligned */
-uint8_t aPacketData[PACKET_1K_SIZE + PACKET_DATA_INDEX + PACKET_TRAILER_SIZE];
+__ALIGNED(4) uint8_t aPacketData[YMODEM_PACKET_BUFFERS][YMODEM_PACKET_BUFFER_SIZE];
+/* Largest block size agreed with the sender in block 0, 0 for standard YMODEM */
+static uint32_t xblockSize;
 
 /* Private function prototypes -----------------------------------------------*/
 static void PrepareIntialPacket(uint8_t *data, const uint8_t *fileName, uint32_t length);
 static void PreparePacket(uint8_t *source, uint8_t *packet, uint8_t pktNr, uint32_t sizeBlk);
 static HAL_StatusTypeDef ReceivePacket(uint8_t *data, uint32_t *length, uint32_t timeout);
-uint16_t UpdateCRC16(uint16_t crcIn, uint8_t byte);
-uint16_t CalCrC16(const uint8_t *data, uint32_t size);
+static uint32_t ParseExtensions(const uint8_t *info, const uint8_t *infoEnd, uint32_t *resume);
+static void YmodemIdle(void);
+static void YmodemRecordSession(TelemetryRecord *telemetry, COM_StatusTypeDef result, uint32_t overruns);
 uint8_t CalcChecksum(const uint8_t *data, uint32_t size);
 
 /* Private functions ---------------------------------------------------------*/
@@ -60,13 +79,14 @@ uint8_t CalcChecksum(const uint8_t *data, uint32_t size);
  */
 static HAL_StatusTypeDef ReceivePacket(uint8_t *data, uint32_t *length, uint32_t timeout)
 {
-    uint32_t crc;
-    uint32_t packet_size = 0;
+    uint32_t crc, crcCalc = 0;
+    uint32_t packet_size = 0, trailerSize, received, count, i;
     HAL_StatusTypeDef status;
     uint8_t char1;
 
+    PROFILE_ENTER(PROFILE_SITE_RECEIVE);
     *length = 0;
-    status = HAL_UART_Receive(&DEBUG_UART, &char1, 1, timeout);
+    status = SerialRxReceive(&char1, 1, timeout);
 
     if (status == HAL_OK)
     {
@@ -78,10 +98,20 @@ static HAL_StatusTypeDef ReceivePacket(uint8_t *data, uint32_t *length, uint32_t
         case STX:
             packet_size = PACKET_1K_SIZE;
             break;
+        case STX_4K:
+        case STX_8K:
+            /* Only after the sender has been told that the receiver supports them */
+            packet_size = (char1 == STX_4K) ? PACKET_4K_SIZE : PACKET_8K_SIZE;
+            if (packet_size > xblockSize)
+            {
+                packet_size = 0;
+                status = HAL_ERROR;
+            }
+            break;
         case EOT:
             break;
         case CA:
-            if ((HAL_UART_Receive(&DEBUG_UART, &char1, 1, timeout) == HAL_OK) && (char1 == CA))
+            if ((SerialRxReceive(&char1, 1, timeout) == HAL_OK) && (char1 == CA))
             {
                 packet_size = 2;
             }
@@ -102,8 +132,30 @@ static HAL_StatusTypeDef ReceivePacket(uint8_t *data, uint32_t *length, uint32_t
 
         if (packet_size >= PACKET_SIZE)
         {
-            status =
-                HAL_UART_Receive(&DEBUG_UART, &data[PACKET_NUMBER_INDEX], packet_size + PACKET_OVERHEAD_SIZE, timeout);
+            /* Extended blocks are protected by a CRC-32 */
+            trailerSize = (packet_size > PACKET_1K_SIZE) ? PACKET_XTRAILER_SIZE : PACKET_TRAILER_SIZE;
+            status = SerialRxReceive(&data[PACKET_NUMBER_INDEX], PACKET_DATA_INDEX - PACKET_NUMBER_INDEX, timeout);
+
+            /* Payload, the CRC is updated with each chunk as it comes out of the ring */
+            for (received = 0; (status == HAL_OK) && (received < packet_size); received += count)
+            {
+                status = SerialRxReceiveSome(&data[PACKET_DATA_INDEX + received], packet_size - received, &count,
+                                             timeout);
+                PROFILE_ENTER(PROFILE_SITE_CRC);
+                if (trailerSize == PACKET_XTRAILER_SIZE)
+                {
+                    crcCalc = Crc32Update(crcCalc, &data[PACKET_DATA_INDEX + received], count);
+                }
+                else
+                {
+                    crcCalc = Crc16Update((uint16_t)crcCalc, &data[PACKET_DATA_INDEX + received], count);
+                }
+                PROFILE_LEAVE(PROFILE_SITE_CRC);
+            }
+            if (status == HAL_OK)
+            {
+                status = SerialRxReceive(&data[PACKET_DATA_INDEX + packet_size], trailerSize, timeout);
+            }
 
             /* Simple packet sanity check */
             if (status == HAL_OK)
@@ -116,9 +168,12 @@ static HAL_StatusTypeDef ReceivePacket(uint8_t *data, uint32_t *length, uint32_t
                 else
                 {
                     /* Check packet CRC */
-                    crc = data[packet_size + PACKET_DATA_INDEX] << 8;
-                    crc += data[packet_size + PACKET_DATA_INDEX + 1];
-                    if (CalCrC16(&data[PACKET_DATA_INDEX], packet_size) != crc)
+                    crc = 0;
+                    for (i = 0; i < trailerSize; i++)
+                    {
+                        crc = (crc << 8) | data[packet_size + PACKET_DATA_INDEX + i];
+                    }
+                    if (crcCalc != crc)
                     {
                         packet_size = 0;
                         status = HAL_ERROR;
@@ -132,9 +187,119 @@ static HAL_StatusTypeDef ReceivePacket(uint8_t *data, uint32_t *length, uint32_t
         }
     }
     *length = packet_size;
+    PROFILE_LEAVE(PROFILE_SITE_RECEIVE);
     return status;
 }
 
+/**
+ * @brief  Look for the extensions offered after the file information of block 0
+ * @param  info: first byte after the file size field
+ * @param  infoEnd: end of the block 0 payload
+ * @param  resume: set if the sender can continue from an offset
+ * @retval Extended block size to use, 0 if not offered or not supported
+ */
+static uint32_t ParseExtensions(const uint8_t *info, const uint8_t *infoEnd, uint32_t *resume)
+{
+    const uint32_t xblockLength = sizeof(YMODEM_XBLOCK_TAG) - 1U;
+    const uint32_t resumeLength = sizeof(YMODEM_RESUME_TAG) - 1U;
+    uint32_t value = 0, xblock = 0;
+    const uint8_t *end;
+
+    *resume = 0;
+
+    /* Skip the remaining standard fields (date, mode, ...) */
+    while ((info < infoEnd) && (*info != 0))
+    {
+        info++;
+    }
+    info++;
+
+    /* Space separated tokens, the string must end inside the block */
+    end = (info < infoEnd) ? memchr(info, 0, infoEnd - info) : NULL;
+    if (end == NULL)
+    {
+        return 0;
+    }
+
+    while (info < end)
+    {
+        if (((uint32_t)(end - info) >= xblockLength) && (memcmp(info, YMODEM_XBLOCK_TAG, xblockLength) == 0))
+        {
+            for (info += xblockLength, value = 0; ISVALIDDEC(*info); info++)
+            {
+                value = (value * 10U) + CONVERTDEC(*info);
+            }
+            if ((value >= PACKET_8K_SIZE) && (YMODEM_XBLOCK_SIZE >= PACKET_8K_SIZE))
+            {
+                xblock = PACKET_8K_SIZE;
+            }
+            else if ((value >= PACKET_4K_SIZE) && (YMODEM_XBLOCK_SIZE >= PACKET_4K_SIZE))
+            {
+                xblock = PACKET_4K_SIZE;
+            }
+        }
+        else if (((uint32_t)(end - info) >= resumeLength) && (memcmp(info, YMODEM_RESUME_TAG, resumeLength) == 0))
+        {
+            *resume = 1;
+        }
+
+        /* Next token */
+        while ((info < end) && (*info != ' '))
+        {
+            info++;
+        }
+        while ((info < end) && (*info == ' '))
+        {
+            info++;
+        }
+    }
+
+    return xblock;
+}
+
+/**
+ * @brief  Program queued packets while the receiver waits for the line
+ * @retval None
+ */
+static void YmodemIdle(void)
+{
+    (void)FlashIfPoll();
+    ResumeCommit(FlashIfGetProgrammed());
+}
+
+/**
+ * @brief  Append the figures of a receive session to the telemetry records
+ * @param  telemetry: counters, size, flags and time collected by the receiver
+ * @param  result: result of the session
+ * @param  overruns: SerialRxGetOverruns() when the session started
+ * @retval None
+ */
+static void YmodemRecordSession(TelemetryRecord *telemetry, COM_StatusTypeDef result, uint32_t overruns)
+{
+    uint32_t sector, eraseTime = 0;
+    const uint32_t programTime = FlashIfGetProgramTime();
+
+    for (sector = 0; sector < FLASHIF_SECTOR_COUNT; sector++)
+    {
+        eraseTime += FlashIfGetEraseTime(sector);
+    }
+
+    telemetry->Status = (uint8_t)result;
+    telemetry->Baud = (uint16_t)(DEBUG_UART.Init.BaudRate / 100U);
+    telemetry->EraseTime = (eraseTime > 0xFFFFU) ? 0xFFFFU : (uint16_t)eraseTime;
+    telemetry->ProgramTime = (programTime > 0xFFFFU) ? 0xFFFFU : (uint16_t)programTime;
+    if (SerialRxGetOverruns() != overruns)
+    {
+        telemetry->Flags |= TELEMETRY_FLAG_OVERRUN;
+    }
+
+    /* A session that failed may leave a slot sector erasing, sector 23 waits for it */
+    while (FlashIfIsErasing() != 0U)
+    {
+    }
+    (void)TelemetryAppend(telemetry);
+}
+
 /**
  * @brief  Prepare the first block
  * @param  data:  output buffer
@@ -145,7 +310,7 @@ static HAL_StatusTypeDef ReceivePacket(uint8_t *data, uint32_t *length, uint32_t
 static void PrepareIntialPacket(uint8_t *data, const uint8_t *fileName, uint32_t length)
 {
     uint32_t i, j = 0;
-    uint8_t astring[10];
+    uint8_t astring[11];
 
     /* first 3 bytes are constant */
     data[PACKET_START_INDEX] = SOH;
@@ -217,52 +382,6 @@ static void PreparePacket(uint8_t *source, uint8_t *packet, uint8_t pktNr, uint3
     }
 }
 
-/**
- * @brief  Update CRC16 for input byte
- * @param  crcIn input value
- * @param  input byte
- * @retval None
- */
-uint16_t UpdateCRC16(uint16_t crcIn, uint8_t byte)
-{
-    uint32_t crc = crcIn;
-    uint32_t in = byte | 0x100;
-
-    do
-    {
-        crc <<= 1;
-        in <<= 1;
-        if (in & 0x100)
-            ++crc;
-        if (crc & 0x10000)
-            crc ^= 0x1021;
-    }
-
-    while (!(in & 0x10000));
-
-    return crc & 0xffffu;
-}
-
-/**
- * @brief  Cal CRC16 for YModem Packet
- * @param  data
- * @param  length
- * @retval None
- */
-uint16_t CalCrC16(const uint8_t *data, uint32_t size)
-{
-    uint32_t crc = 0;
-    const uint8_t *dataEnd = data + size;
-
-    while (data < dataEnd)
-        crc = UpdateCRC16(crc, *data++);
-
-    crc = UpdateCRC16(crc, 0);
-    crc = UpdateCRC16(crc, 0);
-
-    return crc & 0xffffu;
-}
-
 /**
  * @brief  Calculate Check sum for YModem Packet
  * @param  data Pointer to input data
@@ -285,20 +404,39 @@ uint8_t CalcChecksum(const uint8_t *data, uint32_t size)
 /* Public functions ---------------------------------------------------------*/
 /**
  * @brief  Receive a file using the ymodem protocol with CRC16.
+ * @note   The receiver first polls with 'G'. A sender that answers it streams
+ *         the blocks without waiting for ACKs (YMODEM-G); there is no
+ *         retransmission then, so any error cancels the session.
  * @param  size The size of the file.
  * @retval COM_StatusTypeDef result of reception/programming
  */
 COM_StatusTypeDef Ymodem_Receive(uint32_t *size)
 {
-    uint32_t i, packetLength, sessionDone = 0, fileDone, errors = 0, sessionBegin = 0;
+    uint32_t i, packetLength, sessionDone = 0, fileDone, errors = 0, sessionBegin = 0, packetsReceived;
     // uint32_t flashdestination;
-    uint32_t ramsource, filesize;
-    uint8_t *filePtr;
-    uint8_t file_size[FILE_SIZE_LENGTH], tmp, packetsReceived;
+    uint32_t ramsource, filesize = 0, sizeValid, buffer = 0, canResume, resumeOffset;
+    const uint32_t target = SlotGetTarget();
+    const uint32_t imageAddress = SlotGetAddress(target);
+    const uint32_t slotEnd = imageAddress + SlotGetSize(target);
+    uint8_t *filePtr, *packetData;
+    uint8_t file_size[FILE_SIZE_LENGTH], tmp;
+    uint8_t pollChar = CRC16, streaming = 0;
+    uint32_t polls = 0;
     COM_StatusTypeDef result = COM_OK;
+    HAL_StatusTypeDef status;
+    TelemetryRecord telemetry = {0};
+    uint32_t measuring = 0, transferStart = 0;
+    const uint32_t overruns = SerialRxGetOverruns();
+
+    /* Initialize flashdestination variable, the image goes to the inactive slot */
+    flashDestination = imageAddress;
 
-    /* Initialize flashdestination variable */
-    flashDestination = APPLICATION_ADDRESS;
+    /* Standard block sizes until the sender offers more in block 0 */
+    xblockSize = 0;
+
+    /* Data packets are programmed in the background while the next one arrives */
+    FlashIfQueueInit();
+    SerialRxSetIdleHook(YmodemIdle);
 
     while ((sessionDone == 0) && (result == COM_OK))
     {
@@ -306,7 +444,9 @@ COM_StatusTypeDef Ymodem_Receive(uint32_t *size)
         fileDone = 0;
         while ((fileDone == 0) && (result == COM_OK))
         {
-            switch (ReceivePacket(aPacketData, &packetLength, DOWNLOAD_TIMEOUT))
+            packetData = aPacketData[buffer];
+            status = ReceivePacket(packetData, &packetLength, DOWNLOAD_TIMEOUT);
+            switch (status)
             {
             case HAL_OK:
                 errors = 0;
@@ -318,26 +458,54 @@ COM_StatusTypeDef Ymodem_Receive(uint32_t *size)
                     result = COM_ABORT;
                     break;
                 case 0:
-                    /* End of transmission */
-                    SerialPutByte(ACK);
-                    fileDone = 1;
+                    /* End of transmission, the file is complete once the queue has drained */
+                    if (FlashIfFlush() == FLASHIF_OK)
+                    {
+                        /* The wait for the closing block 0 is not part of the transfer */
+                        if ((measuring != 0U) && (telemetry.Time == 0U))
+                        {
+                            telemetry.Time = HAL_GetTick() - transferStart;
+                        }
+                        ResumeCommit(FlashIfGetProgrammed());
+                        SerialPutByte(ACK);
+                        fileDone = 1;
+                    }
+                    else
+                    {
+                        SerialPutByte(CA);
+                        SerialPutByte(CA);
+                        result = COM_DATA;
+                    }
                     break;
                 default:
                     /* Normal packet */
-                    if (aPacketData[PACKET_NUMBER_INDEX] != packetsReceived)
+                    /* The block number wraps, the count must not or block 256 looks like block 0 */
+                    if (packetData[PACKET_NUMBER_INDEX] != (uint8_t)packetsReceived)
                     {
-                        SerialPutByte(NAK);
+                        telemetry.SequenceErrors++;
+                        if (streaming != 0U)
+                        {
+                            /* A block went missing, the sender will not repeat it */
+                            SerialPutByte(CA);
+                            SerialPutByte(CA);
+                            result = COM_ERROR;
+                        }
+                        else
+                        {
+                            SerialPutByte(NAK);
+                            telemetry.Naks++;
+                        }
                     }
                     else
                     {
                         if (packetsReceived == 0)
                         {
                             /* File name packet */
-                            if (aPacketData[PACKET_DATA_INDEX] != 0)
+                            if (packetData[PACKET_DATA_INDEX] != 0)
                             {
                                 /* File name extraction */
                                 i = 0;
-                                filePtr = aPacketData + PACKET_DATA_INDEX;
+                                filePtr = packetData + PACKET_DATA_INDEX;
                                 while ((*filePtr != 0) && (i < FILE_NAME_LENGTH))
                                 {
                                     aFileName[i++] = *filePtr++;
@@ -347,16 +515,26 @@ COM_StatusTypeDef Ymodem_Receive(uint32_t *size)
                                 aFileName[i++] = '\0';
                                 i = 0;
                                 filePtr++;
-                                while ((*filePtr != ' ') && (i < FILE_SIZE_LENGTH))
+                                while ((*filePtr != ' ') && (*filePtr != '\0') && (i < (FILE_SIZE_LENGTH - 1)))
                                 {
                                     file_size[i++] = *filePtr++;
                                 }
                                 file_size[i++] = '\0';
-                                Str2Int(file_size, &filesize);
+                                sizeValid = Str2Int(file_size, &filesize);
+                                xblockSize =
+                                    ParseExtensions(filePtr, packetData + PACKET_DATA_INDEX + packetLength, &canResume);
+
+                                /* Telemetry covers the first file of the session */
+                                if (measuring == 0U)
+                                {
+                                    measuring = 1;
+                                    transferStart = HAL_GetTick();
+                                    telemetry.Size = filesize;
+                                }
 
                                 /* Test the size of the image to be sent */
-                                /* Image size is greater than Flash size */
-                                if (*size > (USER_FLASH_SIZE + 1))
+                                /* Unreadable size, or image size is greater than the slot size */
+                                if ((sizeValid == 0U) || (filesize > SlotGetSize(target)))
                                 {
                                     /* End session */
                                     tmp = CA;
@@ -365,13 +543,47 @@ COM_StatusTypeDef Ymodem_Receive(uint32_t *size)
                                     HAL_UART_Transmit(&DEBUG_UART, &tmp, 1, NAK_TIMEOUT);
                                     RS485_RX_EN();
                                     result = COM_LIMIT;
+                                    break;
                                 }
-                                /* erase user application area */
-                                FlashIfErase(APPLICATION_ADDRESS);
+                                /* Keep what an interrupted transfer of the same image has
+                                   programmed if the sender can continue from there */
+                                resumeOffset = ResumeBegin(
+                                    target, ResumeGetIdentity(packetData + PACKET_DATA_INDEX, packetLength),
+                                    filesize, canResume);
+                                flashDestination = imageAddress + resumeOffset;
+
+                                /* The sender answered the last poll, 'G' selects streaming */
+                                streaming = (pollChar == CRCG);
+                                telemetry.Flags |= ((streaming != 0U) ? TELEMETRY_FLAG_STREAMING : 0U) |
+                                                   ((xblockSize != 0U) ? TELEMETRY_FLAG_XBLOCK : 0U) |
+                                                   ((resumeOffset != 0U) ? TELEMETRY_FLAG_RESUMED : 0U);
+
+                                /* Sectors are erased in the background while the packets
+                                   arrive */
+                                FlashIfErasePlan(flashDestination, imageAddress + filesize, slotEnd);
                                 *size = filesize;
-
                                 SerialPutByte(ACK);
-                                SerialPutByte(CRC16);
+                                if (resumeOffset != 0U)
+                                {
+                                    /* Block 1 will carry the data from this offset */
+                                    SerialPutByte(YMODEM_RESUME_ACCEPT);
+                                    for (i = 0; i < 8U; i++)
+                                    {
+                                        SerialPutByte("0123456789abcdef"[(resumeOffset >> (28U - (4U * i))) & 0x0FU]);
+                                    }
+                                }
+                                if (xblockSize != 0U)
+                                {
+                                    SerialPutByte(YMODEM_XBLOCK_ACCEPT);
+                                }
+                                if (streaming != 0U)
+                                {
+                                    /* Programming pauses while a sector erases and a streaming
+                                       sender does not wait for it. Erase the sectors the ring
+                                       cannot bridge before the 'G' starts the data. */
+                                    (void)FlashIfEraseSlowSectors(SerialRxGetHoldTime());
+                                }
+                                SerialPutByte(pollChar);
                             }
                             /* File header packet is empty, end session */
                             else
@@ -384,12 +596,25 @@ COM_StatusTypeDef Ymodem_Receive(uint32_t *size)
                         }
                         else /* Data packet */
                         {
-                            ramsource = (uint32_t)&aPacketData[PACKET_DATA_INDEX];
-                            /* Write received data in Flash */
-                            if (FlashIfWrite(flashDestination, (uint32_t *)ramsource, packetLength / 4) == FLASHIF_OK)
+                            ramsource = (uint32_t)&packetData[PACKET_DATA_INDEX];
+                            /* Queue received data for Flash, the CRC is already checked so the
+                               packet can be acknowledged before it is programmed */
+                            if ((flashDestination + packetLength) > slotEnd)
+                            {
+                                /* More data than the slot holds, whatever block 0 announced */
+                                SerialPutByte(CA);
+                                SerialPutByte(CA);
+                                result = COM_LIMIT;
+                            }
+                            else if (FlashIfQueueWrite(flashDestination, (uint32_t *)ramsource, packetLength / 4) ==
+                                FLASHIF_OK)
                             {
                                 flashDestination += packetLength;
-                                SerialPutByte(ACK);
+                                buffer = (buffer + 1U) % YMODEM_PACKET_BUFFERS;
+                                if (streaming == 0U)
+                                {
+                                    SerialPutByte(ACK);
+                                }
                             }
                             else /* An error occurred while writing to Flash memory */
                             {
@@ -411,6 +636,28 @@ COM_StatusTypeDef Ymodem_Receive(uint32_t *size)
                 result = COM_ABORT;
                 break;
             default:
+                /* Drop the rest of a damaged frame before asking again */
+                SerialRxFlush();
+                /* Only within a file, not the polls for block 0 */
+                if (packetsReceived > 0U)
+                {
+                    if (status == HAL_TIMEOUT)
+                    {
+                        telemetry.Timeouts++;
+                    }
+                    else
+                    {
+                        telemetry.CrcErrors++;
+                    }
+                }
+                if ((streaming != 0U) && (packetsReceived > 0U))
+                {
+                    /* Bad or missing block while streaming, no retransmission possible */
+                    SerialPutByte(CA);
+                    SerialPutByte(CA);
+                    result = COM_ERROR;
+                    break;
+                }
                 if (sessionBegin > 0)
                 {
                     errors++;
@@ -423,12 +670,33 @@ COM_StatusTypeDef Ymodem_Receive(uint32_t *size)
                 }
                 else
                 {
-                    SerialPutByte(CRC16); /* Ask for a packet */
+                    if (sessionBegin == 0)
+                    {
+                        /* Try streaming first, then plain YMODEM */
+                        pollChar = (polls < YMODEM_G_POLLS) ? CRCG : CRC16;
+                        polls++;
+                    }
+                    else if (packetsReceived > 0U)
+                    {
+                        telemetry.Naks++;
+                    }
+                    SerialPutByte(pollChar); /* Ask for a packet */
                 }
                 break;
             }
         }
     }
+    SerialRxSetIdleHook(NULL);
+
+    /* Kept in Flash for the application and the menu */
+    if (measuring != 0U)
+    {
+        if (telemetry.Time == 0U)
+        {
+            telemetry.Time = HAL_GetTick() - transferStart;
+        }
+        YmodemRecordSession(&telemetry, result, overruns);
+    }
     return result;
 }
 
@@ -454,27 +722,28 @@ COM_StatusTypeDef Ymodem_Transmit(uint8_t *buf, const uint8_t *fileName, uint32_
 #endif /* CRC16_F */
 
     /* Prepare first block - header */
-    PrepareIntialPacket(aPacketData, fileName, fileSize);
+    PrepareIntialPacket(aPacketData[0], fileName, fileSize);
 
     while ((!ackRecpt) && (result == COM_OK))
     {
         /* Send Packet */
         RS485_TX_EN();
-        HAL_UART_Transmit(&DEBUG_UART, &aPacketData[PACKET_START_INDEX], PACKET_SIZE + PACKET_HEADER_SIZE, NAK_TIMEOUT);
+        HAL_UART_Transmit(&DEBUG_UART, &aPacketData[0][PACKET_START_INDEX], PACKET_SIZE + PACKET_HEADER_SIZE,
+                          NAK_TIMEOUT);
         RS485_RX_EN();
 
         /* Send CRC or Check Sum based on CRC16_F */
 #ifdef CRC16_F
-        temp_crc = CalCrC16(&aPacketData[PACKET_DATA_INDEX], PACKET_SIZE);
+        temp_crc = CalCrC16(&aPacketData[0][PACKET_DATA_INDEX], PACKET_SIZE);
         SerialPutByte(temp_crc >> 8);
         SerialPutByte(temp_crc & 0xFF);
 #else  /* CRC16_F */
-        temp_chksum = CalcChecksum(&aPacketData[PACKET_DATA_INDEX], PACKET_SIZE);
+        temp_chksum = CalcChecksum(&aPacketData[0][PACKET_DATA_INDEX], PACKET_SIZE);
         Serial_PutByte(temp_chksum);
 #endif /* CRC16_F */
 
         /* Wait for Ack and 'C' */
-        if (HAL_UART_Receive(&DEBUG_UART, &aRxCtrl[0], 1, NAK_TIMEOUT) == HAL_OK)
+        if (SerialRxReceive(&aRxCtrl[0], 1, NAK_TIMEOUT) == HAL_OK)
         {
             if (aRxCtrl[0] == ACK)
             {
@@ -482,10 +751,10 @@ COM_StatusTypeDef Ymodem_Transmit(uint8_t *buf, const uint8_t *fileName, uint32_
             }
             else if (aRxCtrl[0] == CA)
             {
-                if ((HAL_UART_Receive(&DEBUG_UART, &aRxCtrl[0], 1, NAK_TIMEOUT) == HAL_OK) && (aRxCtrl[0] == CA))
+                if ((SerialRxReceive(&aRxCtrl[0], 1, NAK_TIMEOUT) == HAL_OK) && (aRxCtrl[0] == CA))
                 {
                     HAL_Delay(2);
-                    __HAL_UART_FLUSH_DRREGISTER(&DEBUG_UART);
+                    SerialRxFlush();
                     result = COM_ABORT;
                 }
             }
@@ -507,7 +776,7 @@ COM_StatusTypeDef Ymodem_Transmit(uint8_t *buf, const uint8_t *fileName, uint32_
     while ((size) && (result == COM_OK))
     {
         /* Prepare next packet */
-        PreparePacket(bufInt, aPacketData, blkNumber, size);
+        PreparePacket(bufInt, aPacketData[0], blkNumber, size);
         ackRecpt = 0;
         aRxCtrl[0] = 0;
         errors = 0;
@@ -526,22 +795,22 @@ COM_StatusTypeDef Ymodem_Transmit(uint8_t *buf, const uint8_t *fileName, uint32_
             }
 
             RS485_TX_EN();
-            HAL_UART_Transmit(&DEBUG_UART, &aPacketData[PACKET_START_INDEX], pkt_size + PACKET_HEADER_SIZE,
+            HAL_UART_Transmit(&DEBUG_UART, &aPacketData[0][PACKET_START_INDEX], pkt_size + PACKET_HEADER_SIZE,
                               NAK_TIMEOUT);
             RS485_RX_EN();
 
             /* Send CRC or Check Sum based on CRC16_F */
 #ifdef CRC16_F
-            temp_crc = CalCrC16(&aPacketData[PACKET_DATA_INDEX], pkt_size);
+            temp_crc = CalCrC16(&aPacketData[0][PACKET_DATA_INDEX], pkt_size);
             SerialPutByte(temp_crc >> 8);
             SerialPutByte(temp_crc & 0xFF);
 #else  /* CRC16_F */
-            temp_chksum = CalcChecksum(&aPacketData[PACKET_DATA_INDEX], pkt_size);
+            temp_chksum = CalcChecksum(&aPacketData[0][PACKET_DATA_INDEX], pkt_size);
             Serial_PutByte(temp_chksum);
 #endif /* CRC16_F */
 
             /* Wait for Ack */
-            if ((HAL_UART_Receive(&DEBUG_UART, &aRxCtrl[0], 1, NAK_TIMEOUT) == HAL_OK) && (aRxCtrl[0] == ACK))
+            if ((SerialRxReceive(&aRxCtrl[0], 1, NAK_TIMEOUT) == HAL_OK) && (aRxCtrl[0] == ACK))
             {
                 ackRecpt = 1;
                 if (size > pkt_size)
@@ -585,7 +854,7 @@ COM_StatusTypeDef Ymodem_Transmit(uint8_t *buf, const uint8_t *fileName, uint32_
         SerialPutByte(EOT);
 
         /* Wait for Ack */
-        if (HAL_UART_Receive(&DEBUG_UART, &aRxCtrl[0], 1, NAK_TIMEOUT) == HAL_OK)
+        if (SerialRxReceive(&aRxCtrl[0], 1, NAK_TIMEOUT) == HAL_OK)
         {
             if (aRxCtrl[0] == ACK)
             {
@@ -593,10 +862,10 @@ COM_StatusTypeDef Ymodem_Transmit(uint8_t *buf, const uint8_t *fileName, uint32_
             }
             else if (aRxCtrl[0] == CA)
             {
-                if ((HAL_UART_Receive(&DEBUG_UART, &aRxCtrl[0], 1, NAK_TIMEOUT) == HAL_OK) && (aRxCtrl[0] == CA))
+                if ((SerialRxReceive(&aRxCtrl[0], 1, NAK_TIMEOUT) == HAL_OK) && (aRxCtrl[0] == CA))
                 {
                     HAL_Delay(2);
-                    __HAL_UART_FLUSH_DRREGISTER(&DEBUG_UART);
+                    SerialRxFlush();
                     result = COM_ABORT;
                 }
             }
@@ -616,36 +885,37 @@ COM_StatusTypeDef Ymodem_Transmit(uint8_t *buf, const uint8_t *fileName, uint32_
     if (result == COM_OK)
     {
         /* Preparing an empty packet */
-        aPacketData[PACKET_START_INDEX] = SOH;
-        aPacketData[PACKET_NUMBER_INDEX] = 0;
-        aPacketData[PACKET_CNUMBER_INDEX] = 0xFF;
+        aPacketData[0][PACKET_START_INDEX] = SOH;
+        aPacketData[0][PACKET_NUMBER_INDEX] = 0;
+        aPacketData[0][PACKET_CNUMBER_INDEX] = 0xFF;
         for (i = PACKET_DATA_INDEX; i < (PACKET_SIZE + PACKET_DATA_INDEX); i++)
         {
-            aPacketData[i] = 0x00;
+            aPacketData[0][i] = 0x00;
         }
 
         /* Send Packet */
         RS485_TX_EN();
-        HAL_UART_Transmit(&DEBUG_UART, &aPacketData[PACKET_START_INDEX], PACKET_SIZE + PACKET_HEADER_SIZE, NAK_TIMEOUT);
+        HAL_UART_Transmit(&DEBUG_UART, &aPacketData[0][PACKET_START_INDEX], PACKET_SIZE + PACKET_HEADER_SIZE,
+                          NAK_TIMEOUT);
         RS485_RX_EN();
 
         /* Send CRC or Check Sum based on CRC16_F */
 #ifdef CRC16_F
-        temp_crc = CalCrC16(&aPacketData[PACKET_DATA_INDEX], PACKET_SIZE);
+        temp_crc = CalCrC16(&aPacketData[0][PACKET_DATA_INDEX], PACKET_SIZE);
         SerialPutByte(temp_crc >> 8);
         SerialPutByte(temp_crc & 0xFF);
 #else  /* CRC16_F */
-        temp_chksum = CalcChecksum(&aPacketData[PACKET_DATA_INDEX], PACKET_SIZE);
+        temp_chksum = CalcChecksum(&aPacketData[0][PACKET_DATA_INDEX], PACKET_SIZE);
         Serial_PutByte(temp_chksum);
 #endif /* CRC16_F */
 
         /* Wait for Ack and 'C' */
-        if (HAL_UART_Receive(&DEBUG_UART, &aRxCtrl[0], 1, NAK_TIMEOUT) == HAL_OK)
+        if (SerialRxReceive(&aRxCtrl[0], 1, NAK_TIMEOUT) == HAL_OK)
         {
             if (aRxCtrl[0] == CA)
             {
                 HAL_Delay(2);
-                __HAL_UART_FLUSH_DRREGISTER(&DEBUG_UART);
+                SerialRxFlush();
                 result = COM_ABORT;
             }
         }
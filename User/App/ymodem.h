@@ -52,25 +52,55 @@ typedef enum
 #define PACKET_OVERHEAD_SIZE (PACKET_HEADER_SIZE + PACKET_TRAILER_SIZE - 1)
 #define PACKET_SIZE ((uint32_t)128)
 #define PACKET_1K_SIZE ((uint32_t)1024)
+#define PACKET_4K_SIZE ((uint32_t)4096)
+#define PACKET_8K_SIZE ((uint32_t)8192)
+#define PACKET_XTRAILER_SIZE ((uint32_t)4) /* CRC-32 trailer of the extended blocks */
+
+/* Largest extended block accepted (4096 or 8192), 1024 turns the extension off.
+   Plain number, it is also used in #if */
+#ifndef YMODEM_XBLOCK_SIZE
+#define YMODEM_XBLOCK_SIZE 8192U
+#endif
 
 /* /-------- Packet in IAP memory ------------------------------------------\
  * | 0      |  1    |  2     |  3   |  4      | ... | n+4     | n+5  | n+6  |
  * |------------------------------------------------------------------------|
  * | unused | start | number | !num | data[0] | ... | data[n] | crc0 | crc1 |
  * \------------------------------------------------------------------------/
- * the first byte is left unused for memory alignment reasons                 */
+ * the first byte is left unused for memory alignment reasons
+ * extended blocks (STX_4K/STX_8K) carry a 4 byte CRC-32 (MSB first) instead  */
+
+/* Extensions: a sender that supports them appends a second NUL terminated
+ * string of space separated tokens after the file information of block 0.
+ * A stock receiver ignores the string and a stock sender never sends it, so
+ * both fall back to standard YMODEM. The receiver answers block 0 with ACK,
+ * then the replies below in this order, then the usual 'C'/'G'.
+ *
+ * "xblk=<size>": extended blocks, accepted with YMODEM_XBLOCK_ACCEPT.
+ * "resume"     : the sender can start at an offset. When an interrupted
+ *                transfer of the same image (same block 0 file information)
+ *                can be continued the receiver replies YMODEM_RESUME_ACCEPT
+ *                and the offset as 8 hex digits; block 1 then carries the
+ *                data from that offset. */
+#define YMODEM_XBLOCK_TAG "xblk="
+#define YMODEM_RESUME_TAG "resume"
 
 #define FILE_NAME_LENGTH ((uint32_t)64)
 #define FILE_SIZE_LENGTH ((uint32_t)16)
 
 #define SOH ((uint8_t)0x01)   /* start of 128-byte data packet */
 #define STX ((uint8_t)0x02)   /* start of 1024-byte data packet */
+#define STX_4K ((uint8_t)0x03) /* start of 4096-byte data packet (extended) */
+#define STX_8K ((uint8_t)0x05) /* start of 8192-byte data packet (extended) */
 #define EOT ((uint8_t)0x04)   /* end of transmission */
 #define ACK ((uint8_t)0x06)   /* acknowledge */
 #define NAK ((uint8_t)0x15)   /* negative acknowledge */
 #define CA ((uint32_t)0x18)   /* two of these in succession aborts transfer */
 #define CRC16 ((uint8_t)0x43) /* 'C' == 0x43, request 16-bit CRC */
+#define CRCG ((uint8_t)0x47)  /* 'G' == 0x47, request streaming without ACK (YMODEM-G) */
 #define NEGATIVE_BYTE ((uint8_t)0xFF)
+#define YMODEM_XBLOCK_ACCEPT ((uint8_t)0x58) /* 'X' == 0x58, extended blocks accepted */
+#define YMODEM_RESUME_ACCEPT ((uint8_t)0x52) /* 'R' == 0x52, resume offset follows */
 
 #define ABORT1 ((uint8_t)0x41) /* 'A' == 0x41, abort by user */
 #define ABORT2 ((uint8_t)0x61) /* 'a' == 0x61, abort by user */
@@ -78,6 +108,8 @@ typedef enum
 #define NAK_TIMEOUT ((uint32_t)0x100000)
 #define DOWNLOAD_TIMEOUT ((uint32_t)1000) /* One second retry delay */
 #define MAX_ERRORS ((uint32_t)5)
+/* Number of 'G' polls before falling back to 'C' for senders without YMODEM-G, 0 disables it */
+#define YMODEM_G_POLLS ((uint32_t)3)
 
 /* Exported functions ------------------------------------------------------- */
 COM_StatusTypeDef Ymodem_Receive(uint32_t *p_size);
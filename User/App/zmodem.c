@@ -0,0 +1,725 @@
+/* USER CODE BEGIN Header */
+/**
+ ******************************************************************************
+ * @file           : zmodem.c
+ * @brief          : ZMODEM receiver
+ *
+ *          Receives one file into the application area through the same
+ *          flash write queue as the YMODEM receiver. The receiver announces
+ *          full duplex, overlapped I/O and 32-bit CRC with no buffer limit, so
+ *          the sender streams ZCRCG subpackets without waiting. The receiver
+ *          only talks when the sender asks for an ACK (ZCRCQ/ZCRCW) or on an
+ *          error, where it answers ZRPOS with the last good offset and the
+ *          sender restarts from there.
+ *
+ *          On half-duplex RS485 the sender should stream without a window
+ *          (plain "sz"), otherwise its ZCRCQ acknowledgements collide with the
+ *          data on the line.
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2025 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+/* USER CODE END Header */
+
+/* Includes ------------------------------------------------------------------*/
+#include "zmodem.h"
+#include "common.h"
+#include "crc16.h"
+#include "crc32.h"
+#include "flash_if.h"
+#include "menu.h"
+#include "resume.h"
+#include "serial_rx.h"
+#include "slot.h"
+#include <string.h>
+
+/* Private define ------------------------------------------------------------*/
+#define ZMODEM_XON ((uint8_t)0x11)
+#define ZMODEM_XOFF ((uint8_t)0x13)
+
+/* Results of the byte and frame readers, besides the byte or frame type */
+#define ZM_GOTOR ((int32_t)0x100) /* ZDLE + subpacket terminator, low byte is the terminator */
+#define ZM_TIMEOUT ((int32_t)-1)
+#define ZM_ERROR ((int32_t)-2)
+#define ZM_CANCEL ((int32_t)-3) /* five CAN from the sender */
+#define ZM_ABORT ((int32_t)-4)  /* 'a' typed before the transfer started */
+
+/* Capabilities sent in ZRINIT (ZF0 is the top byte), buffer size 0 means no limit */
+#define ZMODEM_RX_FLAGS ((uint32_t)(CANFDX | CANOVIO | CANFC32) << 24)
+
+/* Bytes skipped while hunting for a header before asking again */
+#define ZMODEM_GARBAGE_MAX ((uint32_t)8192)
+#define ZMODEM_MAX_ERRORS ((uint32_t)10)
+#define ZMODEM_BUFFERS (FLASHIF_QUEUE_DEPTH + 1U)
+
+/* Private variables ---------------------------------------------------------*/
+static uint8_t aZmInput[64];
+static uint32_t zmInputPos;
+static uint32_t zmInputLength;
+
+static uint8_t aZmHeader[5];
+static uint8_t zmHeaderKind;
+static uint8_t aZmSubpacket[ZMODEM_SUBPACKET_SIZE + 1U];
+
+/* Data is collected into whole buffers before it is queued for the flash */
+__ALIGNED(4) static uint8_t aZmData[ZMODEM_BUFFERS][ZMODEM_SUBPACKET_SIZE];
+static uint32_t zmBuffer;
+static uint32_t zmFill;
+static uint32_t zmFlashAddress;
+static uint32_t zmRxPos;
+static uint32_t zmTarget; /* Slot the file is written to */
+
+/* Private function prototypes -----------------------------------------------*/
+static int32_t ZmGetRaw(uint32_t timeout);
+static int32_t ZmGetByte(uint32_t timeout);
+static int32_t ZmGetHex(uint32_t timeout);
+static int32_t ZmReceiveHeader(uint32_t timeout, uint32_t *pos, uint32_t userAbort);
+static int32_t ZmReceiveData(uint32_t *length, uint32_t timeout);
+static void ZmSendHeader(uint8_t type, uint32_t pos);
+static void ZmCancel(void);
+static uint32_t ZmStore(const uint8_t *data, uint32_t length);
+static uint32_t ZmFinish(void);
+static COM_StatusTypeDef ZmReceiveFile(uint32_t *size, uint32_t *started);
+static COM_StatusTypeDef ZmReceiveFrame(uint32_t *errors);
+static void ZmIdle(void);
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Next byte from the line
+ * @param  timeout: timeout duration in ms
+ * @retval Byte value, ZM_TIMEOUT or ZM_ERROR on a receive overrun
+ */
+static int32_t ZmGetRaw(uint32_t timeout)
+{
+    HAL_StatusTypeDef status;
+
+    if (zmInputPos == zmInputLength)
+    {
+        zmInputPos = 0;
+        status = SerialRxReceiveSome(aZmInput, sizeof(aZmInput), &zmInputLength, timeout);
+        if (status != HAL_OK)
+        {
+            zmInputLength = 0;
+            return (status == HAL_TIMEOUT) ? ZM_TIMEOUT : ZM_ERROR;
+        }
+    }
+
+    return aZmInput[zmInputPos++];
+}
+
+/**
+ * @brief  Next byte with ZDLE escapes removed and flow control dropped
+ * @param  timeout: timeout duration in ms
+ * @retval Byte value, ZM_GOTOR | terminator, or a negative ZM_ code
+ */
+static int32_t ZmGetByte(uint32_t timeout)
+{
+    uint32_t cancels = 1;
+    int32_t c;
+
+    do
+    {
+        c = ZmGetRaw(timeout);
+    } while ((c >= 0) && (((c & 0x7F) == ZMODEM_XON) || ((c & 0x7F) == ZMODEM_XOFF)));
+
+    if (c != ZDLE)
+    {
+        return c;
+    }
+
+    for (;;)
+    {
+        c = ZmGetRaw(timeout);
+        if (c < 0)
+        {
+            return c;
+        }
+
+        switch (c)
+        {
+        case ZDLE:
+            /* ZDLE is CAN, five in a row cancel the session */
+            if (++cancels >= 5U)
+            {
+                return ZM_CANCEL;
+            }
+            break;
+        case ZCRCE:
+        case ZCRCG:
+        case ZCRCQ:
+        case ZCRCW:
+            return ZM_GOTOR | c;
+        case ZRUB0:
+            return 0x7F;
+        case ZRUB1:
+            return 0xFF;
+        default:
+            if (((c & 0x7F) == ZMODEM_XON) || ((c & 0x7F) == ZMODEM_XOFF))
+            {
+                break;
+            }
+            return ((c & 0x60) == 0x40) ? (c ^ 0x40) : ZM_ERROR;
+        }
+    }
+}
+
+/**
+ * @brief  Next byte of a hex header (two lower case hex digits)
+ * @param  timeout: timeout duration in ms
+ * @retval Byte value or a negative ZM_ code
+ */
+static int32_t ZmGetHex(uint32_t timeout)
+{
+    int32_t high = ZmGetRaw(timeout);
+    int32_t low = ZmGetRaw(timeout);
+
+    if ((high < 0) || (low < 0))
+    {
+        return (high < 0) ? high : low;
+    }
+    high &= 0x7F;
+    low &= 0x7F;
+    if (!ISVALIDHEX(high) || !ISVALIDHEX(low))
+    {
+        return ZM_ERROR;
+    }
+
+    return (CONVERTHEX(high) << 4) | CONVERTHEX(low);
+}
+
+/**
+ * @brief  Wait for a header of any of the three kinds
+ * @param  timeout: timeout duration in ms for each byte
+ * @param  pos: position field (ZP0 first), flags are in the top byte
+ * @param  userAbort: accept 'a'/'A' on the line as a user abort
+ * @retval Frame type or a negative ZM_ code
+ */
+static int32_t ZmReceiveHeader(uint32_t timeout, uint32_t *pos, uint32_t userAbort)
+{
+    uint32_t garbage = 0, cancels = 0, padding = 0, i, crc, count;
+    uint8_t aCrc[4];
+    int32_t c;
+
+    /* Hunt for ZPAD ZDLE */
+    for (;;)
+    {
+        c = ZmGetRaw(timeout);
+        if (c < 0)
+        {
+            return c;
+        }
+        if ((c == ZDLE) && (padding != 0U))
+        {
+            break;
+        }
+        padding = (c == ZPAD);
+        cancels = (c == CA) ? (cancels + 1U) : 0U;
+        if (cancels >= 5U)
+        {
+            return ZM_CANCEL;
+        }
+        if ((userAbort != 0U) && ((c == ABORT1) || (c == ABORT2)))
+        {
+            return ZM_ABORT;
+        }
+        if (++garbage > ZMODEM_GARBAGE_MAX)
+        {
+            return ZM_ERROR;
+        }
+    }
+
+    c = ZmGetRaw(timeout);
+    if (c < 0)
+    {
+        return c;
+    }
+    zmHeaderKind = (uint8_t)c;
+    count = (c == ZBIN32) ? 4U : 2U;
+
+    for (i = 0; i < (sizeof(aZmHeader) + count); i++)
+    {
+        switch (zmHeaderKind)
+        {
+        case ZHEX:
+            c = ZmGetHex(timeout);
+            break;
+        case ZBIN:
+        case ZBIN32:
+            c = ZmGetByte(timeout);
+            break;
+        default:
+            c = ZM_ERROR;
+            break;
+        }
+        if (c < 0)
+        {
+            return c;
+        }
+        if (c > 0xFF)
+        {
+            return ZM_ERROR;
+        }
+        if (i < sizeof(aZmHeader))
+        {
+            aZmHeader[i] = (uint8_t)c;
+        }
+        else
+        {
+            aCrc[i - sizeof(aZmHeader)] = (uint8_t)c;
+        }
+    }
+
+    if (zmHeaderKind == ZBIN32)
+    {
+        crc = (uint32_t)aCrc[0] | ((uint32_t)aCrc[1] << 8) | ((uint32_t)aCrc[2] << 16) | ((uint32_t)aCrc[3] << 24);
+        if (Crc32Update(0, aZmHeader, sizeof(aZmHeader)) != crc)
+        {
+            return ZM_ERROR;
+        }
+    }
+    else
+    {
+        crc = ((uint32_t)aCrc[0] << 8) | aCrc[1];
+        if (Crc16Update(0, aZmHeader, sizeof(aZmHeader)) != crc)
+        {
+            return ZM_ERROR;
+        }
+    }
+
+    *pos = (uint32_t)aZmHeader[1] | ((uint32_t)aZmHeader[2] << 8) | ((uint32_t)aZmHeader[3] << 16) |
+           ((uint32_t)aZmHeader[4] << 24);
+    return aZmHeader[0];
+}
+
+/**
+ * @brief  Receive one data subpacket into aZmSubpacket
+ * @note   The CRC width follows the header that started the frame.
+ * @param  length: number of data bytes received
+ * @param  timeout: timeout duration in ms for each byte
+ * @retval Subpacket terminator (ZCRCE/G/Q/W) or a negative ZM_ code
+ */
+static int32_t ZmReceiveData(uint32_t *length, uint32_t timeout)
+{
+    const uint32_t crcSize = (zmHeaderKind == ZBIN32) ? 4U : 2U;
+    uint32_t crc = 0, crcCalc, i;
+    uint8_t end;
+    int32_t c;
+
+    *length = 0;
+    for (;;)
+    {
+        c = ZmGetByte(timeout);
+        if (c < 0)
+        {
+            return c;
+        }
+        if ((c & ZM_GOTOR) != 0)
+        {
+            break;
+        }
+        if (*length >= ZMODEM_SUBPACKET_SIZE)
+        {
+            return ZM_ERROR;
+        }
+        aZmSubpacket[(*length)++] = (uint8_t)c;
+    }
+    end = (uint8_t)c;
+
+    for (i = 0; i < crcSize; i++)
+    {
+        c = ZmGetByte(timeout);
+        if ((c < 0) || (c > 0xFF))
+        {
+            return (c == ZM_CANCEL) ? ZM_CANCEL : ZM_ERROR;
+        }
+        /* CRC-32 is sent LSB first, CRC16 MSB first */
+        crc = (crcSize == 4U) ? (crc | ((uint32_t)c << (8U * i))) : ((crc << 8) | (uint32_t)c);
+    }
+
+    /* The terminator is covered by the CRC too */
+    if (crcSize == 4U)
+    {
+        crcCalc = Crc32Update(Crc32Update(0, aZmSubpacket, *length), &end, 1);
+    }
+    else
+    {
+        crcCalc = Crc16Update(Crc16Update(0, aZmSubpacket, *length), &end, 1);
+    }
+
+    return (crcCalc == crc) ? end : ZM_ERROR;
+}
+
+/**
+ * @brief  Send a hex header
+ * @param  type: frame type
+ * @param  pos: position field (ZP0 first), flags are in the top byte
+ * @retval None
+ */
+static void ZmSendHeader(uint8_t type, uint32_t pos)
+{
+    static const uint8_t aHexDigits[] = "0123456789abcdef";
+    uint8_t aFrame[4 + 2 * (sizeof(aZmHeader) + 2U) + 4];
+    uint8_t aHeader[sizeof(aZmHeader) + 2U];
+    uint32_t i, n = 0;
+    uint16_t crc;
+
+    aHeader[0] = type;
+    aHeader[1] = (uint8_t)pos;
+    aHeader[2] = (uint8_t)(pos >> 8);
+    aHeader[3] = (uint8_t)(pos >> 16);
+    aHeader[4] = (uint8_t)(pos >> 24);
+    crc = Crc16Update(0, aHeader, sizeof(aZmHeader));
+    aHeader[5] = (uint8_t)(crc >> 8);
+    aHeader[6] = (uint8_t)crc;
+
+    aFrame[n++] = ZPAD;
+    aFrame[n++] = ZPAD;
+    aFrame[n++] = ZDLE;
+    aFrame[n++] = ZHEX;
+    for (i = 0; i < sizeof(aHeader); i++)
+    {
+        aFrame[n++] = aHexDigits[aHeader[i] >> 4];
+        aFrame[n++] = aHexDigits[aHeader[i] & 0x0F];
+    }
+    aFrame[n++] = '\r';
+    aFrame[n++] = '\n' | 0x80;
+    /* Restart a sender stopped by a stray XOFF, not after the final frames */
+    if ((type != ZFIN) && (type != ZACK))
+    {
+        aFrame[n++] = ZMODEM_XON;
+    }
+    aFrame[n] = '\0';
+
+    SerialPutString(aFrame);
+}
+
+/**
+ * @brief  Cancel the session on the sender side
+ * @retval None
+ */
+static void ZmCancel(void)
+{
+    SerialPutString((const uint8_t *)"\x18\x18\x18\x18\x18\x18\x18\x18\b\b\b\b\b\b\b\b");
+}
+
+/**
+ * @brief  Append verified file data, full buffers are queued for the flash
+ * @param  data: file data
+ * @param  length: number of bytes
+ * @retval FLASHIF_OK, or the error of an earlier queued write
+ */
+static uint32_t ZmStore(const uint8_t *data, uint32_t length)
+{
+    uint32_t status = FLASHIF_OK, chunk;
+
+    while ((length > 0U) && (status == FLASHIF_OK))
+    {
+        chunk = ZMODEM_SUBPACKET_SIZE - zmFill;
+        if (chunk > length)
+        {
+            chunk = length;
+        }
+        memcpy(&aZmData[zmBuffer][zmFill], data, chunk);
+        zmFill += chunk;
+        data += chunk;
+        length -= chunk;
+
+        if (zmFill == ZMODEM_SUBPACKET_SIZE)
+        {
+            status = FlashIfQueueWrite(zmFlashAddress, (uint32_t *)aZmData[zmBuffer], ZMODEM_SUBPACKET_SIZE / 4U);
+            zmFlashAddress += ZMODEM_SUBPACKET_SIZE;
+            zmBuffer = (zmBuffer + 1U) % ZMODEM_BUFFERS;
+            zmFill = 0;
+        }
+    }
+
+    return status;
+}
+
+/**
+ * @brief  Program the rest of the file, padded to a whole word
+ * @retval FLASHIF_OK if all data is in the flash
+ */
+static uint32_t ZmFinish(void)
+{
+    uint32_t status = FLASHIF_OK;
+
+    if (zmFill > 0U)
+    {
+        while ((zmFill % 4U) != 0U)
+        {
+            aZmData[zmBuffer][zmFill++] = 0xFF;
+        }
+        status = FlashIfQueueWrite(zmFlashAddress, (uint32_t *)aZmData[zmBuffer], zmFill / 4U);
+        zmFlashAddress += zmFill;
+        zmFill = 0;
+    }
+
+    return (status == FLASHIF_OK) ? FlashIfFlush() : status;
+}
+
+/**
+ * @brief  Handle ZFILE: name and size, then ask for the data
+ * @note   The data is requested from offset 0, or from where an interrupted
+ *         transfer of the same file stopped.
+ * @param  size: file size announced by the sender
+ * @param  started: set once the data has been requested
+ * @retval COM_OK, or COM_LIMIT if the file does not fit
+ */
+static COM_StatusTypeDef ZmReceiveFile(uint32_t *size, uint32_t *started)
+{
+    uint8_t aFileSize[FILE_SIZE_LENGTH];
+    uint32_t length, i, j;
+
+    if (ZmReceiveData(&length, DOWNLOAD_TIMEOUT) != ZCRCW)
+    {
+        ZmSendHeader(ZNAK, 0);
+        return COM_OK;
+    }
+    aZmSubpacket[length] = '\0';
+
+    /* "name\0size mtime mode ..." */
+    for (i = 0; (aZmSubpacket[i] != '\0') && (i < (FILE_NAME_LENGTH - 1U)); i++)
+    {
+        aFileName[i] = aZmSubpacket[i];
+    }
+    aFileName[i] = '\0';
+    i = strlen((const char *)aZmSubpacket) + 1U;
+    for (j = 0; (i < length) && (aZmSubpacket[i] >= '0') && (aZmSubpacket[i] <= '9') && (j < (FILE_SIZE_LENGTH - 1U));
+         j++)
+    {
+        aFileSize[j] = aZmSubpacket[i++];
+    }
+    aFileSize[j] = '\0';
+    *size = 0;
+    Str2Int(aFileSize, size);
+
+    if (*size > SlotGetSize(zmTarget))
+    {
+        ZmCancel();
+        return COM_LIMIT;
+    }
+
+    zmRxPos = ResumeBegin(zmTarget, ResumeGetIdentity(aZmSubpacket, length), *size, 1);
+    zmFlashAddress = SlotGetAddress(zmTarget) + zmRxPos;
+
+    /* Sectors are erased in the background while the data arrives. Programming
+       pauses meanwhile and the sender streams, so erase the sectors the ring
+       cannot bridge before asking for data. */
+    FlashIfErasePlan(zmFlashAddress, SlotGetAddress(zmTarget) + *size,
+                     SlotGetAddress(zmTarget) + SlotGetSize(zmTarget));
+    (void)FlashIfEraseSlowSectors(SerialRxGetHoldTime());
+
+    zmBuffer = 0;
+    zmFill = 0;
+    ZmSendHeader(ZRPOS, zmRxPos);
+    *started = 1;
+
+    return COM_OK;
+}
+
+/**
+ * @brief  Receive the data subpackets of one ZDATA frame
+ * @param  errors: consecutive error count, cleared on progress
+ * @retval COM_OK to continue with the next header, otherwise the session result
+ */
+static COM_StatusTypeDef ZmReceiveFrame(uint32_t *errors)
+{
+    uint32_t length;
+    int32_t end;
+
+    for (;;)
+    {
+        end = ZmReceiveData(&length, DOWNLOAD_TIMEOUT);
+        if (end == ZM_CANCEL)
+        {
+            return COM_ABORT;
+        }
+        if (end < 0)
+        {
+            /* Bad or missing subpacket, the sender restarts from the last good offset */
+            if (++(*errors) > ZMODEM_MAX_ERRORS)
+            {
+                ZmCancel();
+                return COM_ERROR;
+            }
+            ZmSendHeader(ZRPOS, zmRxPos);
+            return COM_OK;
+        }
+
+        if ((zmRxPos + length) > SlotGetSize(zmTarget))
+        {
+            ZmCancel();
+            return COM_LIMIT;
+        }
+        if (ZmStore(aZmSubpacket, length) != FLASHIF_OK)
+        {
+            /* An error occurred while writing to Flash memory */
+            ZmCancel();
+            return COM_DATA;
+        }
+        zmRxPos += length;
+        *errors = 0;
+
+        switch (end)
+        {
+        case ZCRCW:
+            ZmSendHeader(ZACK, zmRxPos);
+            return COM_OK;
+        case ZCRCQ:
+            ZmSendHeader(ZACK, zmRxPos);
+            break;
+        case ZCRCE:
+            return COM_OK;
+        default: /* ZCRCG */
+            break;
+        }
+    }
+}
+
+/**
+ * @brief  Program queued data while the receiver waits for the line
+ * @retval None
+ */
+static void ZmIdle(void)
+{
+    (void)FlashIfPoll();
+    ResumeCommit(FlashIfGetProgrammed());
+}
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief  Receive a file using the ZMODEM protocol
+ * @note   Only the first file of a batch is programmed, further ones are
+ *         skipped.
+ * @param  size The size of the file.
+ * @retval COM_StatusTypeDef result of reception/programming
+ */
+COM_StatusTypeDef Zmodem_Receive(uint32_t *size)
+{
+    uint32_t pos = 0, length = 0, errors = 0, sessionBegin = 0, fileStarted = 0, fileDone = 0, sessionDone = 0;
+    COM_StatusTypeDef result = COM_OK;
+    int32_t frame;
+
+    zmInputPos = 0;
+    zmInputLength = 0;
+    zmTarget = SlotGetTarget();
+    FlashIfQueueInit();
+    SerialRxSetIdleHook(ZmIdle);
+
+    ZmSendHeader(ZRINIT, ZMODEM_RX_FLAGS);
+
+    while ((sessionDone == 0U) && (result == COM_OK))
+    {
+        frame = ZmReceiveHeader(DOWNLOAD_TIMEOUT, &pos, (sessionBegin == 0U));
+        switch (frame)
+        {
+        case ZRQINIT:
+            ZmSendHeader(ZRINIT, ZMODEM_RX_FLAGS);
+            break;
+        case ZSINIT:
+            /* Attention string, not needed here */
+            sessionBegin = 1;
+            ZmSendHeader((ZmReceiveData(&length, DOWNLOAD_TIMEOUT) == ZCRCW) ? ZACK : ZNAK, 0);
+            break;
+        case ZFILE:
+            sessionBegin = 1;
+            if (fileStarted == 0U)
+            {
+                result = ZmReceiveFile(size, &fileStarted);
+            }
+            else
+            {
+                /* One image per session */
+                (void)ZmReceiveData(&length, DOWNLOAD_TIMEOUT);
+                ZmSendHeader(ZSKIP, 0);
+            }
+            break;
+        case ZDATA:
+            if ((fileStarted == 0U) || (fileDone != 0U))
+            {
+                ZmSendHeader(ZRINIT, ZMODEM_RX_FLAGS);
+            }
+            else if (pos != zmRxPos)
+            {
+                /* Out of step, typically the rest of a stream after an error */
+                ZmSendHeader(ZRPOS, zmRxPos);
+            }
+            else
+            {
+                result = ZmReceiveFrame(&errors);
+            }
+            break;
+        case ZEOF:
+            /* A ZEOF that does not match the received length is stale, ignore it */
+            if ((fileStarted != 0U) && (fileDone == 0U) && (pos == zmRxPos))
+            {
+                if (ZmFinish() == FLASHIF_OK)
+                {
+                    ResumeCommit(FlashIfGetProgrammed());
+                    *size = zmRxPos;
+                    fileDone = 1;
+                    ZmSendHeader(ZRINIT, ZMODEM_RX_FLAGS);
+                }
+                else
+                {
+                    ZmCancel();
+                    result = COM_DATA;
+                }
+            }
+            else if (fileDone != 0U)
+            {
+                ZmSendHeader(ZRINIT, ZMODEM_RX_FLAGS);
+            }
+            break;
+        case ZFIN:
+            ZmSendHeader(ZFIN, 0);
+            /* Over and out ("OO") */
+            (void)ZmGetRaw(TX_TIMEOUT);
+            (void)ZmGetRaw(TX_TIMEOUT);
+            sessionDone = 1;
+            result = (fileDone != 0U) ? COM_OK : COM_ERROR;
+            break;
+        case ZM_CANCEL:
+            result = COM_ABORT;
+            break;
+        case ZM_ABORT:
+            ZmCancel();
+            result = COM_ABORT;
+            break;
+        case ZM_TIMEOUT:
+        case ZM_ERROR:
+            if ((sessionBegin != 0U) && (++errors > ZMODEM_MAX_ERRORS))
+            {
+                ZmCancel();
+                result = COM_ERROR;
+            }
+            else if ((fileStarted != 0U) && (fileDone == 0U))
+            {
+                ZmSendHeader(ZRPOS, zmRxPos);
+            }
+            else
+            {
+                ZmSendHeader(ZRINIT, ZMODEM_RX_FLAGS);
+            }
+            break;
+        default:
+            /* ZCOMMAND and friends are not supported */
+            ZmSendHeader(ZNAK, 0);
+            break;
+        }
+    }
+
+    SerialRxSetIdleHook(NULL);
+    return result;
+}
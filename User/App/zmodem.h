@@ -0,0 +1,83 @@
+/* USER CODE BEGIN Header */
+/**
+ ******************************************************************************
+ * @file           : zmodem.h
+ * @brief          : ZMODEM receiver
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2025 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+/* USER CODE END Header */
+
+#ifndef __ZMODEM_H__
+#define __ZMODEM_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "ymodem.h"
+
+/* Exported constants --------------------------------------------------------*/
+/* Frame delimiters */
+#define ZPAD ((uint8_t)'*')
+#define ZDLE ((uint8_t)0x18)
+#define ZBIN ((uint8_t)'A')
+#define ZHEX ((uint8_t)'B')
+#define ZBIN32 ((uint8_t)'C')
+
+/* Frame types */
+#define ZRQINIT ((uint8_t)0)
+#define ZRINIT ((uint8_t)1)
+#define ZSINIT ((uint8_t)2)
+#define ZACK ((uint8_t)3)
+#define ZFILE ((uint8_t)4)
+#define ZSKIP ((uint8_t)5)
+#define ZNAK ((uint8_t)6)
+#define ZABORT ((uint8_t)7)
+#define ZFIN ((uint8_t)8)
+#define ZRPOS ((uint8_t)9)
+#define ZDATA ((uint8_t)10)
+#define ZEOF ((uint8_t)11)
+#define ZFERR ((uint8_t)12)
+#define ZCRC ((uint8_t)13)
+#define ZCHALLENGE ((uint8_t)14)
+#define ZCOMPL ((uint8_t)15)
+#define ZCAN ((uint8_t)16)
+#define ZFREECNT ((uint8_t)17)
+#define ZCOMMAND ((uint8_t)18)
+
+/* Data subpacket terminators, sent after ZDLE */
+#define ZCRCE ((uint8_t)'h') /* end of frame, header follows */
+#define ZCRCG ((uint8_t)'i') /* frame continues nonstop */
+#define ZCRCQ ((uint8_t)'j') /* frame continues, ZACK expected */
+#define ZCRCW ((uint8_t)'k') /* end of frame, ZACK expected */
+#define ZRUB0 ((uint8_t)'l') /* escaped 0x7F */
+#define ZRUB1 ((uint8_t)'m') /* escaped 0xFF */
+
+/* ZRINIT capability flags (ZF0) */
+#define CANFDX ((uint8_t)0x01)  /* full duplex */
+#define CANOVIO ((uint8_t)0x02) /* receive while writing to storage */
+#define CANFC32 ((uint8_t)0x20) /* 32-bit CRC frames */
+
+/* Largest data subpacket accepted, lrzsz sends 1024 unless told otherwise */
+#define ZMODEM_SUBPACKET_SIZE ((uint32_t)1024)
+
+    /* Exported functions ------------------------------------------------------- */
+    COM_StatusTypeDef Zmodem_Receive(uint32_t *size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ZMODEM_H__ */
@@ -0,0 +1,255 @@
+/* USER CODE BEGIN Header */
+/**
+ ******************************************************************************
+ * @file           : core_cm4.h
+ * @brief          : Host stand-in for the CMSIS compiler intrinsics
+ *
+ *          Found before Drivers/CMSIS/Include by the simulation build. It
+ *          provides everything cmsis_gcc.h would, with the Cortex-M
+ *          instructions replaced by calls into the simulated device, then
+ *          includes the real core_cm4.h. The include guard of cmsis_gcc.h is
+ *          set here so the ARM assembly in it is never seen.
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2025 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+/* USER CODE END Header */
+
+#ifndef __SIM_CORE_CM4_H__
+#define __SIM_CORE_CM4_H__
+
+#include <stdint.h>
+
+/* cmsis_compiler.h includes cmsis_gcc.h, which must stay out */
+#define __CMSIS_GCC_H
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Compiler macros, as in cmsis_gcc.h -----------------------------------------*/
+#ifndef __has_builtin
+#define __has_builtin(x) (0)
+#endif
+#define __ASM __asm
+#define __INLINE inline
+#define __STATIC_INLINE static inline
+#define __STATIC_FORCEINLINE __attribute__((always_inline)) static inline
+#define __NO_RETURN __attribute__((__noreturn__))
+#define __USED __attribute__((used))
+#define __WEAK __attribute__((weak))
+#define __PACKED __attribute__((packed, aligned(1)))
+#define __PACKED_STRUCT struct __attribute__((packed, aligned(1)))
+#define __PACKED_UNION union __attribute__((packed, aligned(1)))
+#define __UNALIGNED_UINT32(x) (*(const uint32_t *)(x))
+#define __UNALIGNED_UINT16_WRITE(addr, val) ((void)(*(uint16_t *)(void *)(addr) = (val)))
+#define __UNALIGNED_UINT16_READ(addr) (*(const uint16_t *)(const void *)(addr))
+#define __UNALIGNED_UINT32_WRITE(addr, val) ((void)(*(uint32_t *)(void *)(addr) = (val)))
+#define __UNALIGNED_UINT32_READ(addr) (*(const uint32_t *)(const void *)(addr))
+#define __ALIGNED(x) __attribute__((aligned(x)))
+#define __RESTRICT __restrict
+#define __COMPILER_BARRIER() __ASM volatile("" ::: "memory")
+
+    /* Simulated device, see sim_device.c ------------------------------------------*/
+    void SimIrqDisable(void);
+    void SimIrqEnable(void);
+    uint32_t SimIrqIsDisabled(void);
+    void SimBarrier(void);
+    __NO_RETURN void SimJump(uint32_t stack);
+
+/* Instructions ---------------------------------------------------------------*/
+#define __NOP() __COMPILER_BARRIER()
+#define __WFI() __COMPILER_BARRIER()
+#define __WFE() __COMPILER_BARRIER()
+#define __SEV() __COMPILER_BARRIER()
+#define __BKPT(value) __builtin_trap()
+#define __CLZ(value) ((uint8_t)(((value) == 0U) ? 32U : (uint32_t)__builtin_clz(value)))
+
+    /* A DSB follows the write of SYSRESETREQ, the reset is taken there */
+    __STATIC_FORCEINLINE void __DSB(void)
+    {
+        __sync_synchronize();
+        SimBarrier();
+    }
+
+    __STATIC_FORCEINLINE void __ISB(void)
+    {
+        __sync_synchronize();
+    }
+
+    __STATIC_FORCEINLINE void __DMB(void)
+    {
+        __sync_synchronize();
+    }
+
+    __STATIC_FORCEINLINE uint32_t __REV(uint32_t value)
+    {
+        return __builtin_bswap32(value);
+    }
+
+    __STATIC_FORCEINLINE uint32_t __REV16(uint32_t value)
+    {
+        return ((value & 0x00FF00FFU) << 8) | ((value >> 8) & 0x00FF00FFU);
+    }
+
+    __STATIC_FORCEINLINE int16_t __REVSH(int16_t value)
+    {
+        return (int16_t)__builtin_bswap16((uint16_t)value);
+    }
+
+    __STATIC_FORCEINLINE uint32_t __ROR(uint32_t op1, uint32_t op2)
+    {
+        op2 %= 32U;
+        return (op2 == 0U) ? op1 : ((op1 >> op2) | (op1 << (32U - op2)));
+    }
+
+    __STATIC_FORCEINLINE uint32_t __RBIT(uint32_t value)
+    {
+        uint32_t result = 0;
+        uint32_t i;
+
+        for (i = 0; i < 32U; i++)
+        {
+            result = (result << 1) | ((value >> i) & 1U);
+        }
+        return result;
+    }
+
+    /* Exclusive accesses never fail, the simulated interrupts take the IRQ lock */
+    __STATIC_FORCEINLINE uint8_t __LDREXB(volatile uint8_t *addr)
+    {
+        return *addr;
+    }
+
+    __STATIC_FORCEINLINE uint16_t __LDREXH(volatile uint16_t *addr)
+    {
+        return *addr;
+    }
+
+    __STATIC_FORCEINLINE uint32_t __LDREXW(volatile uint32_t *addr)
+    {
+        return *addr;
+    }
+
+    __STATIC_FORCEINLINE uint32_t __STREXB(uint8_t value, volatile uint8_t *addr)
+    {
+        *addr = value;
+        return 0;
+    }
+
+    __STATIC_FORCEINLINE uint32_t __STREXH(uint16_t value, volatile uint16_t *addr)
+    {
+        *addr = value;
+        return 0;
+    }
+
+    __STATIC_FORCEINLINE uint32_t __STREXW(uint32_t value, volatile uint32_t *addr)
+    {
+        *addr = value;
+        return 0;
+    }
+
+    __STATIC_FORCEINLINE void __CLREX(void)
+    {
+    }
+
+    /* Core registers ---------------------------------------------------------------*/
+    __STATIC_FORCEINLINE void __enable_irq(void)
+    {
+        SimIrqEnable();
+    }
+
+    __STATIC_FORCEINLINE void __disable_irq(void)
+    {
+        SimIrqDisable();
+    }
+
+    __STATIC_FORCEINLINE uint32_t __get_PRIMASK(void)
+    {
+        return SimIrqIsDisabled();
+    }
+
+    __STATIC_FORCEINLINE void __set_PRIMASK(uint32_t priMask)
+    {
+        if ((priMask & 1U) != 0U)
+        {
+            SimIrqDisable();
+        }
+        else
+        {
+            SimIrqEnable();
+        }
+    }
+
+    __STATIC_FORCEINLINE uint32_t __get_IPSR(void)
+    {
+        return 0;
+    }
+
+    __STATIC_FORCEINLINE uint32_t __get_CONTROL(void)
+    {
+        return 0;
+    }
+
+    __STATIC_FORCEINLINE void __set_CONTROL(uint32_t control)
+    {
+        (void)control;
+    }
+
+    __STATIC_FORCEINLINE uint32_t __get_MSP(void)
+    {
+        return 0;
+    }
+
+    /* Only ever set right before jumping to an application */
+    __STATIC_FORCEINLINE void __set_MSP(uint32_t topOfMainStack)
+    {
+        SimJump(topOfMainStack);
+    }
+
+    __STATIC_FORCEINLINE uint32_t __get_PSP(void)
+    {
+        return 0;
+    }
+
+    __STATIC_FORCEINLINE void __set_PSP(uint32_t topOfProcStack)
+    {
+        (void)topOfProcStack;
+    }
+
+    __STATIC_FORCEINLINE uint32_t __get_BASEPRI(void)
+    {
+        return 0;
+    }
+
+    __STATIC_FORCEINLINE void __set_BASEPRI(uint32_t basePri)
+    {
+        (void)basePri;
+    }
+
+    __STATIC_FORCEINLINE uint32_t __get_FPSCR(void)
+    {
+        return 0;
+    }
+
+    __STATIC_FORCEINLINE void __set_FPSCR(uint32_t fpscr)
+    {
+        (void)fpscr;
+    }
+
+#ifdef __cplusplus
+}
+#endif
+
+#include_next <core_cm4.h>
+
+#endif /* __SIM_CORE_CM4_H__ */
@@ -0,0 +1,33 @@
+/* USER CODE BEGIN Header */
+/**
+ ******************************************************************************
+ * @file           : stm32f4xx_hal_conf.h
+ * @brief          : HAL configuration of the simulation build
+ *
+ *          Found before Core/Inc by the simulation build. Takes the board's
+ *          configuration unchanged and adjusts the HAL macros that rely on
+ *          register side effects the simulated memory map does not have.
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2025 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+/* USER CODE END Header */
+
+#ifndef __SIM_STM32F4xx_HAL_CONF_H
+#define __SIM_STM32F4xx_HAL_CONF_H
+
+#include_next <stm32f4xx_hal_conf.h>
+
+/* FLASH->SR flags are cleared by writing 1, plain memory would set them */
+#undef __HAL_FLASH_CLEAR_FLAG
+#define __HAL_FLASH_CLEAR_FLAG(__FLAG__) (FLASH->SR &= ~(uint32_t)(__FLAG__))
+
+#endif /* __SIM_STM32F4xx_HAL_CONF_H */
@@ -0,0 +1,727 @@
+/* USER CODE BEGIN Header */
+/**
+ ******************************************************************************
+ * @file           : bench_main.c
+ * @brief          : End-to-end update benchmark on the host simulation
+ *
+ *          Runs complete Ymodem_Receive() sessions against a YMODEM sender on
+ *          the other end of the simulated UART7 and reports how long each
+ *          update took. The line runs at the baud rate, sectors take their
+ *          erase time and words their programming time (see sim_device.c),
+ *          the sender waits for the RS485 turnaround before it answers and
+ *          bit errors and lost bytes are injected on the line at the given
+ *          rates. Every throughput change is measured with the same command:
+ *
+ *          bootbench [-s 64K,512K,max] [-m ymodem,ymodem-g,xblk] [-b baud]
+ *                    [-t us] [-e percent] [-p percent] [-r ber] [-d rate] [-n seed]
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2025 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+/* USER CODE END Header */
+
+/* Includes ------------------------------------------------------------------*/
+#define _GNU_SOURCE
+#include "crc16.h"
+#include "crc32.h"
+#include "dma.h"
+#include "flash_if.h"
+#include "gpio.h"
+#include "serial_rx.h"
+#include "sim.h"
+#include "slot.h"
+#include "usart.h"
+#include "ymodem.h"
+
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+/* Private define ------------------------------------------------------------*/
+#define BENCH_MAX_ITEMS 8U
+#define BENCH_RETRIES 10U          /* Tries per block before the sender gives up */
+#define BENCH_REPLY_TIMEOUT 10000U /* Milliseconds to wait for an answer, as sz */
+#define BENCH_POLL_TIMEOUT 60000U  /* Milliseconds to wait for the first poll */
+#define BENCH_LINE_BUFFER 4096U    /* Bytes the sender may have in flight on the line */
+
+/* Private types -------------------------------------------------------------*/
+typedef enum
+{
+    BENCH_YMODEM = 0, /* 1K blocks, each acknowledged */
+    BENCH_YMODEM_G,   /* 1K blocks, streamed after a 'G' poll */
+    BENCH_XBLOCK,     /* 8K blocks with CRC-32 offered in block 0, each acknowledged */
+    BENCH_MODE_COUNT
+} BenchMode;
+
+typedef struct
+{
+    /* Set up by main() */
+    BenchMode Mode;
+    const uint8_t *Image;
+    uint32_t Size;
+    volatile uint32_t Done; /* The receiver has returned */
+
+    /* Results */
+    uint64_t StartUs; /* Block 0 sent */
+    uint64_t EndUs;   /* Session closed */
+    uint32_t Blocks;
+    uint32_t Naks;     /* Blocks repeated on NAK or 'C' */
+    uint32_t Timeouts; /* Blocks repeated for lack of an answer */
+    uint32_t Flips;    /* Bits inverted on the line, both directions */
+    uint32_t Drops;    /* Bytes lost on the line, both directions */
+    uint32_t Closed;   /* 1 once the empty block 0 was acknowledged */
+    uint32_t Cancelled; /* 1 if the receiver sent CA */
+} BenchSession;
+
+/* Private variables ---------------------------------------------------------*/
+SimOptions simOptions = {NULL, NULL, 460800, 100, 100, 0, -1};
+
+static const char *const aModeName[BENCH_MODE_COUNT] = {"ymodem", "ymodem-g", "xblk"};
+
+static uint32_t aSize[BENCH_MAX_ITEMS];
+static uint32_t sizeCount;
+static BenchMode aMode[BENCH_MODE_COUNT];
+static uint32_t modeCount;
+static uint32_t turnaroundUs = 100;
+static double bitErrorRate;
+static double dropRate;
+static uint64_t randomState = 1;
+static int senderFd = -1;
+static uint32_t lastWasRead;
+
+/* Private function prototypes -----------------------------------------------*/
+static void BenchUsage(const char *name);
+static uint32_t BenchParseSize(const char *text);
+static void BenchParseOptions(int argc, char *argv[]);
+static double BenchRandom(void);
+static int BenchRead(BenchSession *session, uint32_t timeout);
+static void BenchWrite(BenchSession *session, const uint8_t *data, uint32_t size);
+static int BenchWaitFor(BenchSession *session, const char *accept, uint32_t timeout);
+static uint32_t BenchBlock(uint8_t *packet, uint32_t number, const uint8_t *data, uint32_t size, uint32_t length);
+static void BenchCancel(void);
+static int BenchSendBlock0(BenchSession *session, uint8_t *packet, uint32_t length, char *poll);
+static void *BenchSender(void *argument);
+static void BenchRun(BenchMode mode, uint32_t size, const uint8_t *image);
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Print the command line help and exit
+ * @param  name: program name
+ * @retval None
+ */
+static void BenchUsage(const char *name)
+{
+    fprintf(stderr,
+            "Usage: %s [-s sizes] [-m modes] [-b baud] [-t us] [-e percent] [-p percent] [-r ber] [-d rate] "
+            "[-n seed]\n"
+            "  -s  image sizes, K and M suffixes, max for the target slot (64K,512K,max)\n"
+            "  -m  ymodem, ymodem-g and/or xblk (all three)\n"
+            "  -b  UART7 rate (460800)\n"
+            "  -t  RS485 turnaround of the sender before each answer, in us (100)\n"
+            "  -e  sector erase time in percent of the typical one (100)\n"
+            "  -p  word programming time in percent of the typical 16 us (100)\n"
+            "  -r  bit error rate on the line, e.g. 1e-6 (0)\n"
+            "  -d  rate of lost bytes on the line, e.g. 1e-5 (0)\n"
+            "  -n  seed of the image data and the line errors (1)\n",
+            name);
+    exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief  Read an image size
+ * @param  text: bytes with an optional K or M suffix, "max" for the target slot
+ * @retval Bytes, 0 for the size of the target slot
+ */
+static uint32_t BenchParseSize(const char *text)
+{
+    char *end;
+    double value;
+
+    if (strcmp(text, "max") == 0)
+    {
+        return 0;
+    }
+
+    value = strtod(text, &end);
+    if ((*end == 'K') || (*end == 'k'))
+    {
+        value *= 1024.0;
+    }
+    else if ((*end == 'M') || (*end == 'm'))
+    {
+        value *= 1024.0 * 1024.0;
+    }
+
+    return (uint32_t)value;
+}
+
+/**
+ * @brief  Read the command line
+ * @param  argc: argument count
+ * @param  argv: arguments
+ * @retval None
+ */
+static void BenchParseOptions(int argc, char *argv[])
+{
+    const char *sizes = "64K,512K,max";
+    const char *modes = "ymodem,ymodem-g,xblk";
+    char list[256];
+    char *item, *rest;
+    uint32_t i;
+    int option;
+
+    while ((option = getopt(argc, argv, "s:m:b:t:e:p:r:d:n:h")) != -1)
+    {
+        switch (option)
+        {
+        case 's':
+            sizes = optarg;
+            break;
+        case 'm':
+            modes = optarg;
+            break;
+        case 'b':
+            simOptions.BaudRate = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 't':
+            turnaroundUs = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'e':
+            simOptions.EraseScale = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'p':
+            simOptions.ProgramScale = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'r':
+            bitErrorRate = strtod(optarg, NULL);
+            break;
+        case 'd':
+            dropRate = strtod(optarg, NULL);
+            break;
+        case 'n':
+            randomState = strtoull(optarg, NULL, 0) | 1U;
+            break;
+        default:
+            BenchUsage(argv[0]);
+            break;
+        }
+    }
+
+    /* Sizes are resolved once the target slot is known */
+    (void)snprintf(list, sizeof(list), "%s", sizes);
+    for (item = strtok_r(list, ",", &rest); (item != NULL) && (sizeCount < BENCH_MAX_ITEMS);
+         item = strtok_r(NULL, ",", &rest))
+    {
+        aSize[sizeCount++] = BenchParseSize(item);
+    }
+
+    (void)snprintf(list, sizeof(list), "%s", modes);
+    for (item = strtok_r(list, ",", &rest); item != NULL; item = strtok_r(NULL, ",", &rest))
+    {
+        for (i = 0; (i < BENCH_MODE_COUNT) && (strcmp(item, aModeName[i]) != 0); i++)
+        {
+        }
+        if ((i == BENCH_MODE_COUNT) || (modeCount == BENCH_MODE_COUNT))
+        {
+            BenchUsage(argv[0]);
+        }
+        aMode[modeCount++] = (BenchMode)i;
+    }
+}
+
+/**
+ * @brief  Uniform random number, xorshift64
+ * @retval Value in [0, 1)
+ */
+static double BenchRandom(void)
+{
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 7;
+    randomState ^= randomState << 17;
+
+    return (double)(randomState >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/**
+ * @brief  Receive a byte from the bootloader, through the noisy line
+ * @param  session: counters
+ * @param  timeout: milliseconds
+ * @retval Byte, -1 on timeout or once the receiver has returned
+ */
+static int BenchRead(BenchSession *session, uint32_t timeout)
+{
+    struct pollfd pfd = {senderFd, POLLIN, 0};
+    uint8_t byte;
+    uint32_t bit;
+
+    while (session->Done == 0U)
+    {
+        if (poll(&pfd, 1, (timeout < 100U) ? (int)timeout : 100) <= 0)
+        {
+            if (timeout <= 100U)
+            {
+                return -1;
+            }
+            timeout -= 100U;
+            continue;
+        }
+        if (read(senderFd, &byte, 1) != 1)
+        {
+            return -1;
+        }
+        if ((dropRate > 0.0) && (BenchRandom() < dropRate))
+        {
+            session->Drops++;
+            continue;
+        }
+        for (bit = 0; (bitErrorRate > 0.0) && (bit < 8U); bit++)
+        {
+            if (BenchRandom() < bitErrorRate)
+            {
+                byte ^= (uint8_t)(1U << bit);
+                session->Flips++;
+            }
+        }
+        lastWasRead = 1;
+        return byte;
+    }
+
+    return -1;
+}
+
+/**
+ * @brief  Send to the bootloader, through the noisy line
+ * @note   The simulated UART takes the bytes at the baud rate. An answer
+ *         starts only after the turnaround time of the RS485 transceiver.
+ * @param  session: counters
+ * @param  data: bytes
+ * @param  size: number of bytes
+ * @retval None
+ */
+static void BenchWrite(BenchSession *session, const uint8_t *data, uint32_t size)
+{
+    static uint8_t aLine[PACKET_8K_SIZE + 16U];
+    uint32_t i, bit, length = 0;
+    ssize_t count;
+
+    if (lastWasRead != 0U)
+    {
+        SimSpin(turnaroundUs);
+        lastWasRead = 0;
+    }
+
+    for (i = 0; i < size; i++)
+    {
+        uint8_t byte = data[i];
+
+        if ((dropRate > 0.0) && (BenchRandom() < dropRate))
+        {
+            session->Drops++;
+            continue;
+        }
+        for (bit = 0; (bitErrorRate > 0.0) && (bit < 8U); bit++)
+        {
+            if (BenchRandom() < bitErrorRate)
+            {
+                byte ^= (uint8_t)(1U << bit);
+                session->Flips++;
+            }
+        }
+        aLine[length++] = byte;
+    }
+
+    for (i = 0; (i < length) && (session->Done == 0U); i += (uint32_t)count)
+    {
+        count = write(senderFd, &aLine[i], length - i);
+        if (count <= 0)
+        {
+            break;
+        }
+    }
+}
+
+/**
+ * @brief  Wait for one of a set of bytes, the rest is menu text
+ * @param  session: counters
+ * @param  accept: bytes to wait for
+ * @param  timeout: milliseconds
+ * @retval Byte, -1 on timeout
+ */
+static int BenchWaitFor(BenchSession *session, const char *accept, uint32_t timeout)
+{
+    const uint64_t end = SimGetMicros() + ((uint64_t)timeout * 1000U);
+    int byte;
+
+    do
+    {
+        byte = BenchRead(session, (uint32_t)((end - SimGetMicros()) / 1000U) + 1U);
+        if ((byte > 0) && (strchr(accept, byte) != NULL))
+        {
+            return byte;
+        }
+    } while ((byte >= 0) && (SimGetMicros() < end));
+
+    return -1;
+}
+
+/**
+ * @brief  Build a packet
+ * @param  packet: output, header, data and trailer
+ * @param  number: block number
+ * @param  data: payload, padded with 0x1A to the block length
+ * @param  size: payload bytes
+ * @param  length: 128, 1024 or 8192
+ * @retval Packet bytes
+ */
+static uint32_t BenchBlock(uint8_t *packet, uint32_t number, const uint8_t *data, uint32_t size, uint32_t length)
+{
+    uint32_t crc;
+
+    packet[0] = (length == PACKET_SIZE) ? SOH : ((length == PACKET_1K_SIZE) ? STX : STX_8K);
+    packet[1] = (uint8_t)number;
+    packet[2] = (uint8_t)~number;
+    memcpy(&packet[PACKET_HEADER_SIZE], data, size);
+    memset(&packet[PACKET_HEADER_SIZE + size], (number == 0U) ? 0x00 : 0x1A, length - size);
+
+    if (length > PACKET_1K_SIZE)
+    {
+        crc = Crc32Update(0, &packet[PACKET_HEADER_SIZE], length);
+        packet[PACKET_HEADER_SIZE + length] = (uint8_t)(crc >> 24);
+        packet[PACKET_HEADER_SIZE + length + 1U] = (uint8_t)(crc >> 16);
+        packet[PACKET_HEADER_SIZE + length + 2U] = (uint8_t)(crc >> 8);
+        packet[PACKET_HEADER_SIZE + length + 3U] = (uint8_t)crc;
+        return PACKET_HEADER_SIZE + length + PACKET_XTRAILER_SIZE;
+    }
+
+    crc = Crc16Update(0, &packet[PACKET_HEADER_SIZE], length);
+    packet[PACKET_HEADER_SIZE + length] = (uint8_t)(crc >> 8);
+    packet[PACKET_HEADER_SIZE + length + 1U] = (uint8_t)crc;
+    return PACKET_HEADER_SIZE + length + PACKET_TRAILER_SIZE;
+}
+
+/**
+ * @brief  Give up: cancel the session, bypassing the line errors
+ * @note   Ymodem_Receive() only returns when told, this is the operator
+ *         ending a session that cannot complete.
+ * @retval None
+ */
+static void BenchCancel(void)
+{
+    static const uint8_t aCancel[] = {CA, CA, CA, CA, CA};
+
+    (void)write(senderFd, aCancel, sizeof(aCancel));
+}
+
+/**
+ * @brief  Send a block 0 until it is acknowledged
+ * @param  session: counters
+ * @param  packet: block 0 built by BenchBlock()
+ * @param  length: its bytes
+ * @param  poll: the receiver's next poll, 'C' or 'G'
+ * @retval 0, -1 if the receiver cancelled or did not answer
+ */
+static int BenchSendBlock0(BenchSession *session, uint8_t *packet, uint32_t length, char *poll)
+{
+    uint32_t tries;
+    int reply;
+
+    for (tries = 0; tries < BENCH_RETRIES; tries++)
+    {
+        BenchWrite(session, packet, length);
+        reply = BenchWaitFor(session, "\x06\x15\x18" "CG", BENCH_REPLY_TIMEOUT);
+        if (reply == ACK)
+        {
+            /* An 'X' for extended blocks may come before the poll */
+            reply = BenchWaitFor(session, "CG", BENCH_REPLY_TIMEOUT);
+            if (reply > 0)
+            {
+                *poll = (char)reply;
+                return 0;
+            }
+        }
+        if (reply == CA)
+        {
+            session->Cancelled = 1;
+            return -1;
+        }
+        if (reply < 0)
+        {
+            session->Timeouts++;
+        }
+        else
+        {
+            session->Naks++;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * @brief  Sender thread: one complete YMODEM session
+ * @param  argument: BenchSession
+ * @retval NULL
+ */
+static void *BenchSender(void *argument)
+{
+    BenchSession *const session = argument;
+    static uint8_t aPacket[PACKET_8K_SIZE + 16U];
+    const uint32_t xblock = (session->Mode == BENCH_XBLOCK) ? PACKET_8K_SIZE : PACKET_1K_SIZE;
+    const char *const wanted = (session->Mode == BENCH_YMODEM_G) ? "G" : "C";
+    uint8_t aInfo[PACKET_SIZE];
+    uint32_t offset, chunk, length, info, tries, number = 1;
+    char pollChar;
+    int reply = -1;
+
+    /* Block 0: name, size and, for extended blocks, the offer */
+    memset(aInfo, 0, sizeof(aInfo));
+    info = (uint32_t)snprintf((char *)aInfo, sizeof(aInfo), "bench.bin%c%lu", 0, (unsigned long)session->Size) + 1U;
+    if (session->Mode == BENCH_XBLOCK)
+    {
+        info += (uint32_t)snprintf((char *)&aInfo[info], sizeof(aInfo) - info, "%s%u", YMODEM_XBLOCK_TAG,
+                                   (unsigned)PACKET_8K_SIZE) + 1U;
+    }
+
+    if (BenchWaitFor(session, wanted, BENCH_POLL_TIMEOUT) < 0)
+    {
+        BenchCancel();
+        return NULL;
+    }
+    session->StartUs = SimGetMicros();
+    length = BenchBlock(aPacket, 0, aInfo, info, PACKET_SIZE);
+    if ((BenchSendBlock0(session, aPacket, length, &pollChar) != 0) || (pollChar != wanted[0]))
+    {
+        BenchCancel();
+        return NULL;
+    }
+
+    /* Data, in 1K blocks once less than an extended block is left */
+    for (offset = 0; offset < session->Size; offset += chunk, number++)
+    {
+        const uint32_t block = ((session->Size - offset) >= xblock) ? xblock : PACKET_1K_SIZE;
+
+        chunk = ((session->Size - offset) < block) ? (session->Size - offset) : block;
+        length = BenchBlock(aPacket, number, &session->Image[offset], chunk, block);
+        session->Blocks++;
+
+        if (session->Mode == BENCH_YMODEM_G)
+        {
+            /* No answers while streaming, only a CA when the receiver gives up */
+            BenchWrite(session, aPacket, length);
+            reply = BenchRead(session, 0);
+            if (reply == CA)
+            {
+                session->Cancelled = 1;
+                return NULL;
+            }
+            continue;
+        }
+
+        for (tries = 0; tries < BENCH_RETRIES; tries++)
+        {
+            BenchWrite(session, aPacket, length);
+            reply = BenchWaitFor(session, "\x06\x15\x18" "C", BENCH_REPLY_TIMEOUT);
+            if ((reply == ACK) || (reply == CA))
+            {
+                break;
+            }
+            if (reply < 0)
+            {
+                session->Timeouts++;
+            }
+            else
+            {
+                session->Naks++;
+            }
+        }
+        if (reply != ACK)
+        {
+            session->Cancelled = (reply == CA) ? 1U : 0U;
+            if (reply != CA)
+            {
+                BenchCancel();
+            }
+            return NULL;
+        }
+    }
+
+    /* End of file, then the empty block 0 that closes the session */
+    for (tries = 0; tries < BENCH_RETRIES; tries++)
+    {
+        aPacket[0] = EOT;
+        BenchWrite(session, aPacket, 1);
+        reply = BenchWaitFor(session, "\x06\x15\x18", BENCH_REPLY_TIMEOUT);
+        if ((reply == ACK) || (reply == CA))
+        {
+            break;
+        }
+    }
+    if (reply != ACK)
+    {
+        session->Cancelled = (reply == CA) ? 1U : 0U;
+        return NULL;
+    }
+    memset(aInfo, 0, sizeof(aInfo));
+    length = BenchBlock(aPacket, 0, aInfo, 0, PACKET_SIZE);
+    reply = BenchWaitFor(session, "CG", BENCH_REPLY_TIMEOUT);
+    for (tries = 0; (reply > 0) && (tries < BENCH_RETRIES); tries++)
+    {
+        BenchWrite(session, aPacket, length);
+        reply = BenchWaitFor(session, "\x06\x15\x18" "CG", BENCH_REPLY_TIMEOUT);
+        if ((reply == ACK) || (reply == CA))
+        {
+            break;
+        }
+    }
+    session->EndUs = SimGetMicros();
+    session->Closed = (reply == ACK) ? 1U : 0U;
+
+    return NULL;
+}
+
+/**
+ * @brief  Run one session and print its line of the report
+ * @param  mode: sender variant
+ * @param  size: image bytes
+ * @param  image: image data
+ * @retval None
+ */
+static void BenchRun(BenchMode mode, uint32_t size, const uint8_t *image)
+{
+    const uint32_t overruns = SerialRxGetOverruns();
+    BenchSession session;
+    pthread_t sender;
+    COM_StatusTypeDef result;
+    uint32_t received = 0, match;
+    double seconds, rate;
+    int pending;
+
+    memset(&session, 0, sizeof(session));
+    session.Mode = mode;
+    session.Image = image;
+    session.Size = size;
+
+    if (pthread_create(&sender, NULL, BenchSender, &session) != 0)
+    {
+        fprintf(stderr, "bench: cannot start the sender\n");
+        exit(EXIT_FAILURE);
+    }
+    result = Ymodem_Receive(&received);
+    session.Done = 1;
+    (void)pthread_join(sender, NULL);
+
+    /* Leftovers of an aborted stream must not start the next session */
+    while ((ioctl(simOptions.UartFd, FIONREAD, &pending) == 0) && (pending > 0))
+    {
+        SimSleep(10000);
+    }
+    SimSleep(100000);
+    SerialRxFlush();
+
+    match = ((result == COM_OK) && (session.Closed != 0U) && (received == size) &&
+             (memcmp((const void *)(uintptr_t)SlotGetAddress(SlotGetTarget()), image, size) == 0))
+                ? 1U
+                : 0U;
+    seconds = (session.EndUs > session.StartUs) ? ((double)(session.EndUs - session.StartUs) / 1e6) : 0.0;
+    rate = (seconds > 0.0) ? ((double)size / seconds) : 0.0;
+
+    printf("%-9s %8lu %9.3f %9.0f %6.1f%% %7lu %6lu %8lu %6lu %6lu %8lu  %s\n", aModeName[mode],
+           (unsigned long)size, seconds, rate, (rate * 1000.0) / (double)simOptions.BaudRate,
+           (unsigned long)session.Blocks, (unsigned long)session.Naks, (unsigned long)session.Timeouts,
+           (unsigned long)session.Flips, (unsigned long)session.Drops,
+           (unsigned long)(SerialRxGetOverruns() - overruns),
+           (match != 0U) ? "ok" : ((session.Cancelled != 0U) ? "cancelled" : "FAILED"));
+    (void)fflush(stdout);
+}
+
+/* Public functions ----------------------------------------------------------*/
+
+int main(int argc, char *argv[])
+{
+    char board[] = "/tmp/bootbench-XXXXXX";
+    int link[2];
+    uint32_t slotSize, i, m, largest = 0;
+    uint8_t *image;
+    int fd;
+
+    BenchParseOptions(argc, argv);
+
+    /* A fresh board each run, the file goes away with the program */
+    fd = mkstemp(board);
+    if ((fd < 0) || (socketpair(AF_UNIX, SOCK_STREAM, 0, link) != 0))
+    {
+        fprintf(stderr, "bench: cannot set up the board\n");
+        return EXIT_FAILURE;
+    }
+    (void)close(fd);
+    /* About a UART FIFO and a driver buffer in flight, not a whole image */
+    (void)setsockopt(link[1], SOL_SOCKET, SO_SNDBUF, &(int){BENCH_LINE_BUFFER}, sizeof(int));
+    simOptions.FlashPath = board;
+    simOptions.UartFd = link[0];
+    senderFd = link[1];
+
+    /* As Core/Src/main.c and Main_Menu() up to the download */
+    SimDeviceInit(argv);
+    (void)unlink(board);
+    HAL_Init();
+    SystemClock_Config();
+    MX_GPIO_Init();
+    MX_DMA_Init();
+    MX_UART4_Init();
+    MX_UART7_Init();
+    FlashIfRelocateVectors();
+    SerialRxInit();
+
+    slotSize = SlotGetSize(SlotGetTarget());
+    for (i = 0; i < sizeCount; i++)
+    {
+        if (aSize[i] > slotSize)
+        {
+            fprintf(stderr, "bench: %lu bytes do not fit the target slot, sending %lu\n", (unsigned long)aSize[i],
+                    (unsigned long)slotSize);
+        }
+        aSize[i] = ((aSize[i] == 0U) || (aSize[i] > slotSize)) ? slotSize : aSize[i];
+        largest = (aSize[i] > largest) ? aSize[i] : largest;
+    }
+    image = malloc(largest);
+    if (image == NULL)
+    {
+        return EXIT_FAILURE;
+    }
+    for (i = 0; i < largest; i++)
+    {
+        image[i] = (uint8_t)(BenchRandom() * 256.0);
+    }
+
+    printf("%lu baud, turnaround %lu us, erase %lu%%, program %lu%%, BER %g, drop %g, target slot 0x%08lX (%lu "
+           "bytes)\n",
+           (unsigned long)simOptions.BaudRate, (unsigned long)turnaroundUs, (unsigned long)simOptions.EraseScale,
+           (unsigned long)simOptions.ProgramScale, bitErrorRate, dropRate,
+           (unsigned long)SlotGetAddress(SlotGetTarget()), (unsigned long)slotSize);
+    printf("%-9s %8s %9s %9s %7s %7s %6s %8s %6s %6s %8s  %s\n", "mode", "bytes", "seconds", "bytes/s", "line",
+           "blocks", "naks", "timeouts", "flips", "drops", "overruns", "result");
+    for (m = 0; m < modeCount; m++)
+    {
+        for (i = 0; i < sizeCount; i++)
+        {
+            BenchRun(aMode[m], aSize[i], image);
+        }
+    }
+
+    free(image);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,206 @@
+/* USER CODE BEGIN Header */
+/**
+ ******************************************************************************
+ * @file           : crc16_test.c
+ * @brief          : CRC16 implementations against the original byte loop
+ *
+ *          Built once per CRC16_IMPL (crc16test_bitwise, crc16test_table,
+ *          crc16test_slice4). Checks that Crc16Update() gives the same result
+ *          as the UpdateCRC16() loop the YMODEM receiver started from, for
+ *          every length up to a few blocks, every alignment and split into
+ *          chained calls, then times both over 1K packets:
+ *
+ *          crc16test_<impl> [megabytes]
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2025 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+/* USER CODE END Header */
+
+/* Includes ------------------------------------------------------------------*/
+#include "crc16.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/* Private define ------------------------------------------------------------*/
+#define TEST_MAX_LENGTH 2100U   /* Lengths 0 to this, covers 1K blocks and the tail of 2K */
+#define TEST_ALIGNMENTS 4U      /* Start offsets, the slices read 4 bytes at a time */
+#define TEST_PACKET_SIZE 1024U  /* Benchmark unit, one YMODEM data block */
+#define TEST_DEFAULT_MBYTES 16U /* Benchmark volume without an argument */
+
+#if (CRC16_IMPL == CRC16_IMPL_BITWISE)
+#define TEST_IMPL_NAME "BITWISE"
+#elif (CRC16_IMPL == CRC16_IMPL_TABLE)
+#define TEST_IMPL_NAME "TABLE"
+#else
+#define TEST_IMPL_NAME "SLICE4"
+#endif
+
+/* Private variables ---------------------------------------------------------*/
+static uint8_t aTestData[TEST_MAX_LENGTH + TEST_ALIGNMENTS];
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Shift one byte through the CRC register, the loop of the ST IAP
+ *         example the receiver used before crc16.c
+ * @param  crcIn: CRC register
+ * @param  byte: data byte
+ * @retval Updated register
+ */
+static uint16_t UpdateCRC16(uint16_t crcIn, uint8_t byte)
+{
+    uint32_t crc = crcIn;
+    uint32_t in = byte | 0x100;
+
+    do
+    {
+        crc <<= 1;
+        in <<= 1;
+        if (in & 0x100)
+            ++crc;
+        if (crc & 0x10000)
+            crc ^= 0x1021;
+    }
+
+    while (!(in & 0x10000));
+
+    return crc & 0xffffu;
+}
+
+/**
+ * @brief  CRC16 of a buffer the way the receiver computed it before
+ * @note   The register is fed the data and then two zero bytes.
+ * @param  data: buffer
+ * @param  size: length of the buffer
+ * @retval CRC16 of the data
+ */
+static uint16_t TestReferenceCrc(const uint8_t *data, uint32_t size)
+{
+    uint32_t crc = 0;
+    const uint8_t *dataEnd = data + size;
+
+    while (data < dataEnd)
+    {
+        crc = UpdateCRC16(crc, *data++);
+    }
+
+    crc = UpdateCRC16(crc, 0);
+    crc = UpdateCRC16(crc, 0);
+
+    return crc & 0xffffu;
+}
+
+/**
+ * @brief  Compare Crc16Update() with the reference
+ * @retval Number of mismatches
+ */
+static uint32_t TestEquivalence(void)
+{
+    uint32_t length, offset, split, failures = 0;
+    uint16_t expected, crc;
+
+    /* The XMODEM check value */
+    if (CalCrC16((const uint8_t *)"123456789", 9) != 0x31C3U)
+    {
+        printf("check value: 0x%04X, expected 0x31C3\n", CalCrC16((const uint8_t *)"123456789", 9));
+        failures++;
+    }
+
+    for (length = 0; length <= TEST_MAX_LENGTH; length++)
+    {
+        for (offset = 0; offset < TEST_ALIGNMENTS; offset++)
+        {
+            expected = TestReferenceCrc(&aTestData[offset], length);
+
+            crc = CalCrC16(&aTestData[offset], length);
+            if (crc != expected)
+            {
+                printf("length %u offset %u: 0x%04X, expected 0x%04X\n", length, offset, crc, expected);
+                failures++;
+            }
+
+            /* Chained as the receiver does when a block arrives in pieces */
+            for (split = 0; (split <= length) && (length <= (3U * TEST_PACKET_SIZE / 2U)); split += 1U + (split / 7U))
+            {
+                crc = Crc16Update(Crc16Update(0, &aTestData[offset], split), &aTestData[offset + split],
+                                  length - split);
+                if (crc != expected)
+                {
+                    printf("length %u offset %u split %u: 0x%04X, expected 0x%04X\n", length, offset, split, crc,
+                           expected);
+                    failures++;
+                }
+            }
+        }
+    }
+
+    return failures;
+}
+
+/**
+ * @brief  Time a CRC function over 1K packets
+ * @param  function: Crc16 function to time
+ * @param  packets: number of packets
+ * @retval Megabytes per second
+ */
+static double TestThroughput(uint16_t (*function)(const uint8_t *, uint32_t), uint32_t packets)
+{
+    struct timespec start, end;
+    volatile uint16_t sink = 0;
+    double seconds;
+    uint32_t i;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < packets; i++)
+    {
+        sink ^= function(aTestData, TEST_PACKET_SIZE);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    (void)sink;
+
+    seconds = (double)(end.tv_sec - start.tv_sec) + ((double)(end.tv_nsec - start.tv_nsec) / 1e9);
+
+    return ((double)packets * TEST_PACKET_SIZE) / (seconds * 1048576.0);
+}
+
+/* Public functions ----------------------------------------------------------*/
+
+int main(int argc, char **argv)
+{
+    const uint32_t mbytes = (argc > 1) ? (uint32_t)strtoul(argv[1], NULL, 0) : TEST_DEFAULT_MBYTES;
+    const uint32_t packets = mbytes * (1048576U / TEST_PACKET_SIZE);
+    double reference, implementation;
+    uint32_t i, failures;
+
+    srand(1);
+    for (i = 0; i < sizeof(aTestData); i++)
+    {
+        aTestData[i] = (uint8_t)rand();
+    }
+
+    failures = TestEquivalence();
+    printf("CRC16_IMPL %s: %s, lengths 0 to %u at %u alignments\n", TEST_IMPL_NAME,
+           (failures == 0U) ? "matches UpdateCRC16" : "MISMATCH", TEST_MAX_LENGTH, TEST_ALIGNMENTS);
+
+    if (packets > 0U)
+    {
+        reference = TestThroughput(TestReferenceCrc, packets);
+        implementation = TestThroughput(CalCrC16, packets);
+        printf("%u MB in 1K packets: UpdateCRC16 %.1f MB/s, %s %.1f MB/s (x%.1f)\n", mbytes, reference,
+               TEST_IMPL_NAME, implementation, implementation / reference);
+    }
+
+    return (failures == 0U) ? 0 : 1;
+}
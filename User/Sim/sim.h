@@ -0,0 +1,83 @@
+/* USER CODE BEGIN Header */
+/**
+ ******************************************************************************
+ * @file           : sim.h
+ * @brief          : Host simulation of the bootloader board
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2025 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+/* USER CODE END Header */
+
+#ifndef __SIM_H__
+#define __SIM_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Includes ------------------------------------------------------------------*/
+#include "stm32f4xx_hal.h"
+
+/* Exported constants --------------------------------------------------------*/
+/* 2 MB of Flash in 24 sectors, followed in the board file by the backup domain */
+#define SIM_FLASH_SIZE ((uint32_t)0x00200000)
+#define SIM_SECTOR_COUNT ((uint32_t)24)
+/* Page holding TIM14, RTC with its backup registers and WWDG, kept in the board
+   file so the backup registers survive a reset as on the chip */
+#define SIM_BACKUP_PAGE ((uint32_t)0x40002000)
+#define SIM_PAGE_SIZE ((uint32_t)0x1000)
+
+/* Vectors of the STM32F429, copied by FlashIfRelocateVectors() */
+#define SIM_VECTOR_WORDS ((uint32_t)107)
+
+    /* Exported types ------------------------------------------------------------*/
+    typedef struct
+    {
+        const char *FlashPath; /* Board file: Flash image and backup domain */
+        const char *LinkPath;  /* Symlink to the UART pty, NULL for none */
+        uint32_t BaudRate;     /* UART7 receive rate, 0 for as fast as the pty delivers */
+        uint32_t EraseScale;   /* Sector erase time in percent of the typical one */
+        uint32_t ProgramScale; /* Word programming time in percent of the typical one */
+        uint8_t MenuKeys;      /* DIP1 and DIP2 held, the bootloader stays in the menu */
+        int UartFd;            /* Connected UART7 line, -1 to create a pty */
+    } SimOptions;
+
+    /* Exported variables --------------------------------------------------------*/
+    extern SimOptions simOptions;
+
+    /* Exported functions ------------------------------------------------------- */
+    /* Board setup of Core/Src/main.c, see sim_hal.c */
+    void SystemClock_Config(void);
+
+    void SimDeviceInit(char *argv[]);
+    uint32_t SimGetTick(void);
+    uint64_t SimGetMicros(void);
+    void SimSleep(uint32_t microseconds);
+    void SimSpin(uint32_t microseconds);
+
+    void SimUartStart(uint8_t *ring, uint32_t size);
+    void SimUartStop(void);
+    void SimUartWrite(const uint8_t *data, uint32_t size, uint32_t timeout);
+    void SimLogWrite(const uint8_t *data, uint32_t size);
+
+    uint32_t SimFlashGetSector(uint32_t address);
+    void SimFlashErase(uint32_t sector);
+    HAL_StatusTypeDef SimFlashEraseStart(uint32_t sector, uint32_t count, uint32_t interrupt);
+
+    void SimCrcFeed(const uint32_t *data, uint32_t words);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SIM_H__ */
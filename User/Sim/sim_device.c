@@ -0,0 +1,1043 @@
+/* USER CODE BEGIN Header */
+/**
+ ******************************************************************************
+ * @file           : sim_device.c
+ * @brief          : Simulated GD32F4xx memory map, Flash, UART7 and core
+ *
+ *          The Flash, the SRAM, the peripherals and the Cortex-M system space
+ *          are mapped at their real addresses, so the bootloader reads its
+ *          images and registers exactly as on the chip. The host binary is
+ *          linked below 4 GB (no PIE) so its 32-bit address arithmetic holds.
+ *
+ *          The Flash and the backup domain come from a board file: what was
+ *          programmed is there after a reset or the next run. Registers are
+ *          plain memory, a device thread plays the hardware that changes
+ *          them behind the CPU's back: the cycle counter, the UART7 receive
+ *          DMA, the UART4 transmit DMA and the background sector erase. Interrupt handlers run on
+ *          that thread while it holds the interrupt lock, which
+ *          __disable_irq() takes, so they preempt the main loop just where the
+ *          chip would let them.
+ *
+ *          On x86-64 the Flash is mapped read-only. A CPU store to it traps,
+ *          is single-stepped and then treated as the FMC would: it needs
+ *          FLASH_CR_PG, can only clear bits and takes the word programming
+ *          time. The simulation's own writes go through a second mapping.
+ *
+ *          UART7 is a pseudo terminal, or a connected socket given by the
+ *          caller. Bytes come in and go out at the baud rate. A system reset
+ *          re-executes the program and hands the terminal over, so a sender
+ *          stays connected. UART4, the log, goes to stderr.
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2025 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+/* USER CODE END Header */
+
+/* Includes ------------------------------------------------------------------*/
+#define _GNU_SOURCE
+#include "sim.h"
+#include "usart.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Private define ------------------------------------------------------------*/
+#ifndef MAP_FIXED_NOREPLACE
+#define MAP_FIXED_NOREPLACE 0x100000
+#endif
+
+/* Single-step a trapped Flash store, x86-64 only */
+#if defined(__x86_64__)
+#define SIM_FLASH_TRAP 1
+#define SIM_EFLAGS_TF ((greg_t)0x100)
+#include <ucontext.h>
+#endif
+
+#define SIM_THREAD_PERIOD_US ((uint32_t)20)
+#define SIM_PROGRAM_TIME_NS ((uint64_t)16000) /* Word programming time, typical of the STM32F429 at x32 */
+#define SIM_TRAP_BYTES ((uint32_t)16)
+#define SIM_SPIN_NS ((uint64_t)100000) /* Waits shorter than this yield instead of sleeping */
+#define SIM_ENV_UART "SIM_UART_FD"
+#define SIM_CRC_POLY ((uint32_t)0x04C11DB7)
+
+/* Private types -------------------------------------------------------------*/
+typedef struct
+{
+    uint32_t Address;
+    uint32_t Size;
+} SimRegion;
+
+/* Private variables ---------------------------------------------------------*/
+/* Sector sizes of the 2 MB GD32F4xx, both banks */
+static const uint32_t aSectorSize[SIM_SECTOR_COUNT] = {
+    0x4000,  0x4000,  0x4000,  0x4000,  0x10000, 0x20000, 0x20000, 0x20000, 0x20000, 0x20000, 0x20000, 0x20000,
+    0x4000,  0x4000,  0x4000,  0x4000,  0x10000, 0x20000, 0x20000, 0x20000, 0x20000, 0x20000, 0x20000, 0x20000};
+
+/* Mapped as anonymous memory, the Flash and the backup page come from the file */
+static const SimRegion aRegions[] = {
+    {CCMDATARAM_BASE, 0x10000}, /* CCM */
+    {0x1FFF0000, 0x10000},      /* System memory, OTP, unique ID, option bytes */
+    {SRAM1_BASE, 0x70000},      /* SRAM of the GD32F470 */
+    {PERIPH_BASE, 0x80000},     /* APB1, APB2, AHB1 */
+    {0xE0000000, 0x100000},     /* Private peripheral bus */
+};
+
+static char **simArgv;
+static int uartFd = -1;
+static struct timespec simStart;
+static uint8_t *flashAlias; /* Writable mapping of the Flash */
+static pthread_t deviceThread;
+static pthread_mutex_t irqLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t deviceLock = PTHREAD_MUTEX_INITIALIZER;
+static uint32_t irqDisabled;
+
+/* UART7 receive DMA, circular */
+static uint8_t *uartRing;
+static uint32_t uartSize;
+static uint32_t uartPos;
+static uint64_t uartLineNs; /* End of the last byte received on the line */
+static uint64_t uartSendNs; /* End of the last byte sent */
+
+/* UART4 transmit DMA, the log */
+static uint32_t logBusy;
+static uint64_t logDoneNs; /* End of the last byte on the line */
+
+/* Background erase */
+static uint32_t eraseSector = 0xFFFFFFFFU;
+static uint32_t eraseLast;
+static uint32_t eraseInterrupt;
+static uint64_t eraseDoneUs;
+
+/* Flash store being single-stepped */
+#ifdef SIM_FLASH_TRAP
+static volatile uint32_t trapPending;
+static uint32_t trapAddress;
+static uint8_t aTrapOld[SIM_TRAP_BYTES];
+static uint64_t trapStartNs;
+static uint64_t programDoneNs;
+#endif
+
+/* Private function prototypes -----------------------------------------------*/
+static uint64_t SimGetNanos(void);
+static void SimWaitNanos(uint64_t until);
+static uint64_t SimByteNanos(void);
+static void SimMap(uint32_t address, uint32_t size, int fd, off_t offset, int replace);
+static int SimOpenBoard(const char *path);
+static void SimOpenUart(void);
+#ifdef SIM_FLASH_TRAP
+static void SimFlashDefault(int signal);
+static void SimFlashFault(int signal, siginfo_t *info, void *context);
+static void SimFlashStep(int signal, siginfo_t *info, void *context);
+static void SimFlashTrapInit(void);
+#endif
+static uint32_t SimFlashEraseTime(uint32_t sector);
+static void SimRunIrq(void (*handler)(uint32_t), uint32_t value);
+static void SimUartEvent(uint32_t pos);
+static void SimFlashEvent(uint32_t sector);
+static void SimLogEvent(uint32_t value);
+static void SimDeviceClock(uint64_t *lastNs);
+static void SimDeviceUart(void);
+static void SimDeviceLog(void);
+static void SimDeviceErase(void);
+static void *SimDeviceRun(void *argument);
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Time since the program (or the last reset) started
+ * @retval Nanoseconds
+ */
+static uint64_t SimGetNanos(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)(now.tv_sec - simStart.tv_sec) * 1000000000U + (uint64_t)(now.tv_nsec - simStart.tv_nsec);
+}
+
+/**
+ * @brief  Wait more precisely than the host's sleep granularity
+ * @note   Sleeps for most of a long wait, then yields until the time is up so
+ *         the device thread keeps running on a single core.
+ * @param  until: SimGetNanos() time to wait for
+ * @retval None
+ */
+static void SimWaitNanos(uint64_t until)
+{
+    uint64_t now;
+
+    while ((now = SimGetNanos()) < until)
+    {
+        if ((until - now) > (SIM_SPIN_NS * 2U))
+        {
+            SimSleep((uint32_t)((until - now - SIM_SPIN_NS) / 1000U));
+        }
+        else
+        {
+            (void)sched_yield();
+        }
+    }
+}
+
+/**
+ * @brief  Time a byte takes on UART7: start bit, 8 data bits, stop bit
+ * @retval Nanoseconds, 0 if the rate is not limited
+ */
+static uint64_t SimByteNanos(void)
+{
+    return (simOptions.BaudRate != 0U) ? (10000000000U / simOptions.BaudRate) : 0U;
+}
+
+/**
+ * @brief  Map a region of the target address space
+ * @param  address: target address
+ * @param  size: bytes
+ * @param  fd: file to map, -1 for zeroed memory
+ * @param  offset: offset in the file
+ * @param  replace: 1 to map over a region mapped before
+ * @retval None, exits if the host cannot give that address
+ */
+static void SimMap(uint32_t address, uint32_t size, int fd, off_t offset, int replace)
+{
+    void *const want = (void *)(uintptr_t)address;
+    const int flags = ((fd < 0) ? (MAP_PRIVATE | MAP_ANONYMOUS) : MAP_SHARED) |
+                      ((replace != 0) ? MAP_FIXED : MAP_FIXED_NOREPLACE);
+    void *got;
+
+    got = mmap(want, size, PROT_READ | PROT_WRITE, flags, fd, offset);
+    if (got != want)
+    {
+        fprintf(stderr, "sim: cannot map 0x%08lX: %s\n", (unsigned long)address, strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * @brief  Open the board file, create an erased one if needed
+ * @param  path: file name
+ * @retval File descriptor
+ */
+static int SimOpenBoard(const char *path)
+{
+    const off_t size = (off_t)SIM_FLASH_SIZE + SIM_PAGE_SIZE;
+    const int fd = open(path, O_RDWR | O_CREAT, 0644);
+    static uint8_t aErased[0x4000];
+    uint32_t i;
+
+    if (fd < 0)
+    {
+        fprintf(stderr, "sim: cannot open %s: %s\n", path, strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+
+    if (lseek(fd, 0, SEEK_END) < size)
+    {
+        /* A new board: Flash erased, backup domain cleared */
+        memset(aErased, 0xFF, sizeof(aErased));
+        for (i = 0; i < SIM_FLASH_SIZE; i += sizeof(aErased))
+        {
+            if (pwrite(fd, aErased, sizeof(aErased), i) != (ssize_t)sizeof(aErased))
+            {
+                fprintf(stderr, "sim: cannot write %s\n", path);
+                exit(EXIT_FAILURE);
+            }
+        }
+        if (ftruncate(fd, size) != 0)
+        {
+            fprintf(stderr, "sim: cannot size %s\n", path);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    return fd;
+}
+
+/**
+ * @brief  Create the pseudo terminal of UART7, or take it over after a reset
+ * @retval None
+ */
+static void SimOpenUart(void)
+{
+    const char *inherited = getenv(SIM_ENV_UART);
+    struct termios tio;
+    char *name;
+    int slave;
+
+    if (simOptions.UartFd >= 0)
+    {
+        uartFd = simOptions.UartFd;
+        return;
+    }
+    if (inherited != NULL)
+    {
+        uartFd = atoi(inherited);
+        return;
+    }
+
+    uartFd = posix_openpt(O_RDWR | O_NOCTTY);
+    if ((uartFd < 0) || (grantpt(uartFd) != 0) || (unlockpt(uartFd) != 0) || ((name = ptsname(uartFd)) == NULL))
+    {
+        fprintf(stderr, "sim: cannot create a pty: %s\n", strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+
+    /* Keep one end open, or reads fail whenever no sender is attached. A
+       binary protocol runs on it, no line discipline. */
+    slave = open(name, O_RDWR | O_NOCTTY);
+    if ((slave < 0) || (tcgetattr(slave, &tio) != 0))
+    {
+        fprintf(stderr, "sim: cannot open %s: %s\n", name, strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+    cfmakeraw(&tio);
+    (void)tcsetattr(slave, TCSANOW, &tio);
+
+    if (simOptions.LinkPath != NULL)
+    {
+        (void)unlink(simOptions.LinkPath);
+        if (symlink(name, simOptions.LinkPath) != 0)
+        {
+            fprintf(stderr, "sim: cannot link %s: %s\n", simOptions.LinkPath, strerror(errno));
+        }
+    }
+    fprintf(stderr, "sim: UART7 on %s\n", (simOptions.LinkPath != NULL) ? simOptions.LinkPath : name);
+}
+
+#ifdef SIM_FLASH_TRAP
+/**
+ * @brief  Hand a fault that is not a Flash store back to the system
+ * @param  signal: SIGSEGV or SIGTRAP
+ * @retval None, the faulting instruction runs again and ends the program
+ */
+static void SimFlashDefault(int signal)
+{
+    struct sigaction action;
+
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = SIG_DFL;
+    (void)sigaction(signal, &action, NULL);
+}
+
+/**
+ * @brief  A store to the read-only Flash: let it through for one instruction
+ * @param  signal: SIGSEGV
+ * @param  info: faulting address
+ * @param  context: CPU state, the trap flag is set in it
+ * @retval None
+ */
+static void SimFlashFault(int signal, siginfo_t *info, void *context)
+{
+    ucontext_t *const uc = context;
+    const uint32_t address = (uint32_t)(uintptr_t)info->si_addr;
+    uint32_t i;
+
+    if ((address < FLASH_BASE) || (address >= (FLASH_BASE + SIM_FLASH_SIZE)) || (trapPending != 0U))
+    {
+        SimFlashDefault(signal);
+        return;
+    }
+
+    /* Keep what the store may overwrite, a word or two around the address */
+    trapAddress = address & ~(SIM_TRAP_BYTES - 1U);
+    for (i = 0; i < SIM_TRAP_BYTES; i++)
+    {
+        aTrapOld[i] = flashAlias[(trapAddress - FLASH_BASE) + i];
+    }
+    trapStartNs = SimGetNanos();
+    trapPending = 1;
+
+    (void)mprotect((void *)(uintptr_t)(address & ~(SIM_PAGE_SIZE - 1U)), SIM_PAGE_SIZE, PROT_READ | PROT_WRITE);
+    uc->uc_mcontext.gregs[REG_EFL] |= SIM_EFLAGS_TF;
+}
+
+/**
+ * @brief  The trapped store is done: program it as the FMC would
+ * @note   Without FLASH_CR_PG the Flash keeps its content and PGSERR is set.
+ *         Otherwise bits only go from 1 to 0 and the CPU stalls for the
+ *         programming time of each word, after an erase still running.
+ * @param  signal: SIGTRAP
+ * @param  info: unused
+ * @param  context: CPU state, the trap flag is cleared in it
+ * @retval None
+ */
+static void SimFlashStep(int signal, siginfo_t *info, void *context)
+{
+    ucontext_t *const uc = context;
+    uint8_t *const cell = &flashAlias[trapAddress - FLASH_BASE];
+    const uint64_t wordNs = (SIM_PROGRAM_TIME_NS * simOptions.ProgramScale) / 100U;
+    uint32_t i, words = 0;
+
+    (void)info;
+    if (trapPending == 0U)
+    {
+        SimFlashDefault(signal);
+        return;
+    }
+    uc->uc_mcontext.gregs[REG_EFL] &= ~SIM_EFLAGS_TF;
+
+    while ((FLASH->SR & FLASH_SR_BSY) != 0U)
+    {
+    }
+
+    if (((FLASH->CR & FLASH_CR_PG) == 0U) || ((FLASH->CR & FLASH_CR_LOCK) != 0U))
+    {
+        memcpy(cell, aTrapOld, SIM_TRAP_BYTES);
+        FLASH->SR |= FLASH_SR_PGSERR;
+    }
+    else
+    {
+        for (i = 0; i < SIM_TRAP_BYTES; i += 4U)
+        {
+            if (memcmp(&cell[i], &aTrapOld[i], 4U) != 0)
+            {
+                words++;
+            }
+        }
+        for (i = 0; i < SIM_TRAP_BYTES; i++)
+        {
+            cell[i] &= aTrapOld[i];
+        }
+
+        /* A word written with its current value is programmed all the same.
+           The time of the trap itself counts towards it. */
+        if (programDoneNs < trapStartNs)
+        {
+            programDoneNs = trapStartNs;
+        }
+        programDoneNs += ((words != 0U) ? words : 1U) * wordNs;
+        SimWaitNanos(programDoneNs);
+    }
+
+    (void)mprotect((void *)(uintptr_t)(trapAddress & ~(SIM_PAGE_SIZE - 1U)), SIM_PAGE_SIZE, PROT_READ);
+    trapPending = 0;
+}
+
+/**
+ * @brief  Make the Flash read-only and catch the CPU's stores to it
+ * @retval None
+ */
+static void SimFlashTrapInit(void)
+{
+    struct sigaction action;
+
+    memset(&action, 0, sizeof(action));
+    action.sa_flags = SA_SIGINFO;
+    action.sa_sigaction = SimFlashFault;
+    (void)sigaction(SIGSEGV, &action, NULL);
+    action.sa_sigaction = SimFlashStep;
+    (void)sigaction(SIGTRAP, &action, NULL);
+
+    (void)mprotect((void *)(uintptr_t)FLASH_BASE, SIM_FLASH_SIZE, PROT_READ);
+}
+#endif
+
+/**
+ * @brief  Time to erase a sector, typical values of the STM32F429 at x32
+ * @param  sector: sector number
+ * @retval Microseconds, scaled by the -e option
+ */
+static uint32_t SimFlashEraseTime(uint32_t sector)
+{
+    uint32_t typical = 1000000U;
+
+    if (aSectorSize[sector] == 0x4000U)
+    {
+        typical = 250000U;
+    }
+    else if (aSectorSize[sector] == 0x10000U)
+    {
+        typical = 550000U;
+    }
+
+    return (uint32_t)(((uint64_t)typical * simOptions.EraseScale) / 100U);
+}
+
+/**
+ * @brief  Run an interrupt handler once the CPU has interrupts enabled
+ * @param  handler: callback
+ * @param  value: its argument
+ * @retval None
+ */
+static void SimRunIrq(void (*handler)(uint32_t), uint32_t value)
+{
+    pthread_mutex_lock(&irqLock);
+    handler(value);
+    pthread_mutex_unlock(&irqLock);
+}
+
+/**
+ * @brief  UART7 Rx event interrupt, as the HAL raises it for an idle line
+ * @param  pos: DMA write position
+ * @retval None
+ */
+static void SimUartEvent(uint32_t pos)
+{
+    HAL_UARTEx_RxEventCallback(&huart7, (uint16_t)pos);
+}
+
+/**
+ * @brief  Flash interrupt at the end of a sector erase
+ * @param  sector: erased sector, 0xFFFFFFFF once the request is complete
+ * @retval None
+ */
+static void SimFlashEvent(uint32_t sector)
+{
+    HAL_FLASH_EndOfOperationCallback(sector);
+}
+
+/**
+ * @brief  UART4 interrupt at the end of a DMA transmission
+ * @param  value: unused
+ * @retval None
+ */
+static void SimLogEvent(uint32_t value)
+{
+    (void)value;
+    huart4.gState = HAL_UART_STATE_READY;
+    HAL_UART_TxCpltCallback(&huart4);
+}
+
+/**
+ * @brief  Advance the DWT cycle counter at the current core clock
+ * @param  lastNs: host time of the previous update, in nanoseconds
+ * @retval None
+ */
+static void SimDeviceClock(uint64_t *lastNs)
+{
+    struct timespec now;
+    const uint64_t khz = SystemCoreClock / 1000U;
+    uint64_t ns, cycles;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    ns = (uint64_t)now.tv_sec * 1000000000U + (uint64_t)now.tv_nsec;
+    cycles = ((ns - *lastNs) * khz) / 1000000U;
+    if (cycles == 0U)
+    {
+        return;
+    }
+    *lastNs += (cycles * 1000000U) / khz;
+
+    if ((DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk) != 0U)
+    {
+        DWT->CYCCNT += (uint32_t)cycles;
+    }
+}
+
+/**
+ * @brief  Move bytes from the pty into the receive ring, at the baud rate
+ * @note   Bytes arriving while the DMA is off are lost, as on the line.
+ * @retval None
+ */
+static void SimDeviceUart(void)
+{
+    struct pollfd pfd = {uartFd, POLLIN, 0};
+    const uint64_t byteNs = SimByteNanos();
+    const uint64_t now = SimGetNanos();
+    uint8_t aDrop[256];
+    uint8_t *into = aDrop;
+    uint32_t room = sizeof(aDrop), pos = 0;
+    ssize_t count = 0;
+
+    pthread_mutex_lock(&deviceLock);
+    if ((poll(&pfd, 1, 0) <= 0) || ((pfd.revents & POLLIN) == 0))
+    {
+        /* The line is idle, the next byte takes its full time from now */
+        uartLineNs = now;
+        pthread_mutex_unlock(&deviceLock);
+        return;
+    }
+
+    if (uartRing != NULL)
+    {
+        /* Up to the end of the ring, the rest comes on the next round */
+        into = &uartRing[uartPos];
+        room = uartSize - uartPos;
+    }
+    if ((byteNs != 0U) && (((now - uartLineNs) / byteNs) < room))
+    {
+        room = (uint32_t)((now - uartLineNs) / byteNs);
+    }
+    if (room > 0U)
+    {
+        count = read(uartFd, into, room);
+    }
+
+    if (count > 0)
+    {
+        uartLineNs += (uint64_t)count * byteNs;
+        if (into != aDrop)
+        {
+            __sync_synchronize();
+            uartPos = (uartPos + (uint32_t)count) % uartSize;
+            /* NDTR counts down and reloads in circular mode */
+            huart7.hdmarx->Instance->NDTR = uartSize - uartPos;
+            pos = uartPos;
+        }
+    }
+    pthread_mutex_unlock(&deviceLock);
+
+    if ((count > 0) && (into != aDrop))
+    {
+        SimRunIrq(SimUartEvent, pos);
+    }
+}
+
+/**
+ * @brief  Complete the log transmission once its bytes have been on the line
+ * @retval None
+ */
+static void SimDeviceLog(void)
+{
+    uint32_t done = 0;
+
+    pthread_mutex_lock(&deviceLock);
+    if ((logBusy != 0U) && (SimGetNanos() >= logDoneNs))
+    {
+        logBusy = 0;
+        done = 1;
+    }
+    pthread_mutex_unlock(&deviceLock);
+
+    if (done != 0U)
+    {
+        SimRunIrq(SimLogEvent, 0);
+    }
+}
+
+/**
+ * @brief  Finish the background erase of a sector when its time is up
+ * @retval None
+ */
+static void SimDeviceErase(void)
+{
+    uint32_t sector, last, interrupt;
+
+    pthread_mutex_lock(&deviceLock);
+    sector = eraseSector;
+    last = (sector == eraseLast) ? 1U : 0U;
+    interrupt = eraseInterrupt;
+    if ((sector == 0xFFFFFFFFU) || ((SimGetNanos() / 1000U) < eraseDoneUs))
+    {
+        pthread_mutex_unlock(&deviceLock);
+        return;
+    }
+    SimFlashErase(sector);
+    if (last == 0U)
+    {
+        eraseSector = sector + 1U;
+        eraseDoneUs = (SimGetNanos() / 1000U) + SimFlashEraseTime(sector + 1U);
+    }
+    else
+    {
+        eraseSector = 0xFFFFFFFFU;
+        FLASH->SR &= ~FLASH_SR_BSY;
+    }
+    pthread_mutex_unlock(&deviceLock);
+
+    if (interrupt != 0U)
+    {
+        SimRunIrq(SimFlashEvent, sector);
+        if (last != 0U)
+        {
+            SimRunIrq(SimFlashEvent, 0xFFFFFFFFU);
+        }
+    }
+}
+
+/**
+ * @brief  Device thread, the hardware running next to the CPU
+ * @param  argument: unused
+ * @retval Never returns
+ */
+static void *SimDeviceRun(void *argument)
+{
+    struct timespec now;
+    uint64_t lastNs;
+
+    (void)argument;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    lastNs = (uint64_t)now.tv_sec * 1000000000U + (uint64_t)now.tv_nsec;
+
+    while (1)
+    {
+        SimDeviceClock(&lastNs);
+        SimDeviceUart();
+        SimDeviceLog();
+        SimDeviceErase();
+        SimSleep(SIM_THREAD_PERIOD_US);
+    }
+
+    return NULL;
+}
+
+/* Public functions ----------------------------------------------------------*/
+
+/**
+ * @brief  Power up the board
+ * @param  argv: command line, used again to restart on a system reset
+ * @retval None
+ */
+void SimDeviceInit(char *argv[])
+{
+    const int board = SimOpenBoard(simOptions.FlashPath);
+    uint32_t i;
+
+    simArgv = argv;
+    clock_gettime(CLOCK_MONOTONIC, &simStart);
+
+    for (i = 0; i < sizeof(aRegions) / sizeof(aRegions[0]); i++)
+    {
+        SimMap(aRegions[i].Address, aRegions[i].Size, -1, 0, 0);
+    }
+    SimMap(FLASH_BASE, SIM_FLASH_SIZE, board, 0, 0);
+    /* Over its place in the peripheral region */
+    SimMap(SIM_BACKUP_PAGE, SIM_PAGE_SIZE, board, SIM_FLASH_SIZE, 1);
+
+    flashAlias = mmap(NULL, SIM_FLASH_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, board, 0);
+    if (flashAlias == MAP_FAILED)
+    {
+        fprintf(stderr, "sim: cannot map the Flash: %s\n", strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+#ifdef SIM_FLASH_TRAP
+    SimFlashTrapInit();
+#endif
+
+    /* Reset values the bootloader depends on */
+    SCB->VTOR = FLASH_BASE;
+    FLASH->CR = FLASH_CR_LOCK;
+
+    SimOpenUart();
+
+    if (pthread_create(&deviceThread, NULL, SimDeviceRun, NULL) != 0)
+    {
+        fprintf(stderr, "sim: cannot start the device thread\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+/**
+ * @brief  HAL tick
+ * @retval Milliseconds since reset
+ */
+uint32_t SimGetTick(void)
+{
+    return (uint32_t)(SimGetNanos() / 1000000U);
+}
+
+/**
+ * @brief  Time since the program (or the last reset) started
+ * @retval Microseconds
+ */
+uint64_t SimGetMicros(void)
+{
+    return SimGetNanos() / 1000U;
+}
+
+/**
+ * @brief  Wait precisely, yielding the host CPU rather than sleeping
+ * @param  microseconds: time to wait
+ * @retval None
+ */
+void SimSpin(uint32_t microseconds)
+{
+    SimWaitNanos(SimGetNanos() + ((uint64_t)microseconds * 1000U));
+}
+
+/**
+ * @brief  Wait without burning the host CPU
+ * @param  microseconds: time to wait
+ * @retval None
+ */
+void SimSleep(uint32_t microseconds)
+{
+    const struct timespec wait = {microseconds / 1000000U, (long)(microseconds % 1000000U) * 1000};
+
+    (void)nanosleep(&wait, NULL);
+}
+
+/**
+ * @brief  Start circular reception of UART7 into a ring
+ * @param  ring: DMA buffer
+ * @param  size: its size in bytes
+ * @retval None
+ */
+void SimUartStart(uint8_t *ring, uint32_t size)
+{
+    pthread_mutex_lock(&deviceLock);
+    uartRing = ring;
+    uartSize = size;
+    uartPos = 0;
+    huart7.hdmarx->Instance->NDTR = size;
+    pthread_mutex_unlock(&deviceLock);
+}
+
+/**
+ * @brief  Stop the reception of UART7
+ * @retval None
+ */
+void SimUartStop(void)
+{
+    pthread_mutex_lock(&deviceLock);
+    uartRing = NULL;
+    pthread_mutex_unlock(&deviceLock);
+}
+
+/**
+ * @brief  Send on UART7, at the baud rate
+ * @note   Each byte leaves once it has been on the line, so the call blocks
+ *         as HAL_UART_Transmit() does. What the pty does not take within the
+ *         timeout is dropped, as a UART sends whether anybody listens or not.
+ * @param  data: bytes to send
+ * @param  size: number of bytes
+ * @param  timeout: milliseconds to wait for room
+ * @retval None
+ */
+void SimUartWrite(const uint8_t *data, uint32_t size, uint32_t timeout)
+{
+    struct pollfd pfd = {uartFd, POLLOUT, 0};
+    const uint64_t byteNs = SimByteNanos();
+    uint32_t chunk;
+    ssize_t count;
+
+    while (size > 0U)
+    {
+        /* A few bytes at a time, so a long message trickles out as on the line */
+        chunk = (size < 16U) ? size : 16U;
+        if (uartSendNs < SimGetNanos())
+        {
+            uartSendNs = SimGetNanos();
+        }
+        uartSendNs += chunk * byteNs;
+        SimWaitNanos(uartSendNs);
+
+        if (poll(&pfd, 1, (timeout > 1000U) ? 1000 : (int)timeout) <= 0)
+        {
+            return;
+        }
+        count = write(uartFd, data, chunk);
+        if (count <= 0)
+        {
+            return;
+        }
+        data += count;
+        size -= (uint32_t)count;
+    }
+}
+
+/**
+ * @brief  Start a DMA transmission on UART4
+ * @note   The bytes are on stderr right away, the transmit complete interrupt
+ *         follows after their time on the line.
+ * @param  data: bytes to send
+ * @param  size: number of bytes
+ * @retval None
+ */
+void SimLogWrite(const uint8_t *data, uint32_t size)
+{
+    (void)fwrite(data, 1, size, stderr);
+
+    pthread_mutex_lock(&deviceLock);
+    logDoneNs = SimGetNanos() + ((uint64_t)size * 10000000000U) / huart4.Init.BaudRate;
+    logBusy = 1;
+    pthread_mutex_unlock(&deviceLock);
+}
+
+/**
+ * @brief  Sector holding a Flash address
+ * @param  address: Flash address
+ * @retval Sector number, SIM_SECTOR_COUNT if outside the Flash
+ */
+uint32_t SimFlashGetSector(uint32_t address)
+{
+    uint32_t start = FLASH_BASE;
+    uint32_t sector;
+
+    for (sector = 0; sector < SIM_SECTOR_COUNT; sector++)
+    {
+        if ((address >= start) && (address < (start + aSectorSize[sector])))
+        {
+            break;
+        }
+        start += aSectorSize[sector];
+    }
+
+    return sector;
+}
+
+/**
+ * @brief  Erase a sector at once
+ * @param  sector: sector number
+ * @retval None
+ */
+void SimFlashErase(uint32_t sector)
+{
+    uint32_t start = FLASH_BASE;
+    uint32_t i;
+
+    for (i = 0; i < sector; i++)
+    {
+        start += aSectorSize[i];
+    }
+    memset(&flashAlias[start - FLASH_BASE], 0xFF, aSectorSize[sector]);
+}
+
+/**
+ * @brief  Erase sectors in the background, FLASH_SR_BSY is set meanwhile
+ * @param  sector: first sector
+ * @param  count: number of sectors
+ * @param  interrupt: 1 to raise the Flash interrupt after each sector
+ * @retval HAL_OK, or HAL_BUSY if an erase is running
+ */
+HAL_StatusTypeDef SimFlashEraseStart(uint32_t sector, uint32_t count, uint32_t interrupt)
+{
+    HAL_StatusTypeDef status = HAL_BUSY;
+
+    pthread_mutex_lock(&deviceLock);
+    if (eraseSector == 0xFFFFFFFFU)
+    {
+        eraseSector = sector;
+        eraseLast = sector + count - 1U;
+        eraseInterrupt = interrupt;
+        eraseDoneUs = (SimGetNanos() / 1000U) + SimFlashEraseTime(sector);
+        FLASH->SR |= FLASH_SR_BSY;
+        status = HAL_OK;
+    }
+    pthread_mutex_unlock(&deviceLock);
+
+    return status;
+}
+
+/**
+ * @brief  Feed words to the CRC unit
+ * @note   The DMA path of Crc32HwCompute() ends here. A write of CRC_CR_RESET
+ *         is seen at the next feed.
+ * @param  data: words
+ * @param  words: number of words
+ * @retval None
+ */
+void SimCrcFeed(const uint32_t *data, uint32_t words)
+{
+    uint32_t crc = CRC->DR;
+    uint32_t i, bit;
+
+    if ((CRC->CR & CRC_CR_RESET) != 0U)
+    {
+        CRC->CR &= ~CRC_CR_RESET;
+        crc = 0xFFFFFFFFU;
+    }
+
+    for (i = 0; i < words; i++)
+    {
+        crc ^= data[i];
+        for (bit = 0; bit < 32U; bit++)
+        {
+            crc = ((crc & 0x80000000U) != 0U) ? ((crc << 1) ^ SIM_CRC_POLY) : (crc << 1);
+        }
+    }
+
+    CRC->DR = crc;
+}
+
+/**
+ * @brief  __disable_irq(): hold off the device thread's interrupt handlers
+ * @retval None
+ */
+void SimIrqDisable(void)
+{
+    if (pthread_equal(pthread_self(), deviceThread))
+    {
+        return;
+    }
+    if (irqDisabled == 0U)
+    {
+        pthread_mutex_lock(&irqLock);
+        irqDisabled = 1;
+    }
+}
+
+/**
+ * @brief  __enable_irq(): let pending interrupt handlers run
+ * @retval None
+ */
+void SimIrqEnable(void)
+{
+    if (pthread_equal(pthread_self(), deviceThread))
+    {
+        return;
+    }
+    if (irqDisabled != 0U)
+    {
+        irqDisabled = 0;
+        pthread_mutex_unlock(&irqLock);
+    }
+}
+
+/**
+ * @brief  __get_PRIMASK()
+ * @retval 1 if interrupts are masked
+ */
+uint32_t SimIrqIsDisabled(void)
+{
+    return pthread_equal(pthread_self(), deviceThread) ? 1U : irqDisabled;
+}
+
+/**
+ * @brief  __DSB(): take a system reset requested through SCB->AIRCR
+ * @note   The program starts over with the same arguments and keeps the pty.
+ *         The Flash and the backup registers are in the board file, the rest
+ *         of the RAM and the registers start from zero.
+ * @retval None
+ */
+void SimBarrier(void)
+{
+    char value[16];
+
+    if ((SCB->AIRCR & SCB_AIRCR_SYSRESETREQ_Msk) == 0U)
+    {
+        return;
+    }
+
+    fprintf(stderr, "sim: system reset\n");
+    (void)snprintf(value, sizeof(value), "%d", uartFd);
+    (void)setenv(SIM_ENV_UART, value, 1);
+    (void)execv("/proc/self/exe", simArgv);
+
+    fprintf(stderr, "sim: cannot restart: %s\n", strerror(errno));
+    exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief  __set_MSP(): the bootloader hands over to an application
+ * @note   The application is ARM code, the simulation ends here.
+ * @param  stack: initial stack pointer of the application
+ * @retval Does not return
+ */
+void SimJump(uint32_t stack)
+{
+    extern uint32_t jumpAddress;
+
+    fprintf(stderr, "sim: jump to the application, SP 0x%08lX, reset handler 0x%08lX\n", (unsigned long)stack,
+            (unsigned long)jumpAddress);
+    exit(EXIT_SUCCESS);
+}
@@ -0,0 +1,440 @@
+/* USER CODE BEGIN Header */
+/**
+ ******************************************************************************
+ * @file           : sim_hal.c
+ * @brief          : HAL functions used by User/App, on the simulated device
+ *
+ *          Only what the bootloader calls is here, with the behaviour it
+ *          relies on: word programming can only clear bits, sector erases
+ *          take their time, UART7 runs through the pty. The board setup of
+ *          Core/Src (clocks, GPIO, UART handles) is reduced to what the
+ *          bootloader reads back.
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2025 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+/* USER CODE END Header */
+
+/* Includes ------------------------------------------------------------------*/
+#include "main.h"
+#include "dma.h"
+#include "gpio.h"
+#include "sim.h"
+#include "usart.h"
+
+#include <string.h>
+
+/* Private define ------------------------------------------------------------*/
+/* PLL output set up by SystemClock_Config() */
+#define SIM_PLL_CLOCK ((uint32_t)180000000)
+
+/* Exported variables --------------------------------------------------------*/
+uint32_t SystemCoreClock = HSI_VALUE;
+
+UART_HandleTypeDef huart4;
+UART_HandleTypeDef huart7;
+DMA_HandleTypeDef hdma_uart7_rx;
+
+/* RAM vector table of the linker script, _eram_vector is defined by the build */
+uint32_t _sram_vector[SIM_VECTOR_WORDS];
+
+/* Board setup ---------------------------------------------------------------*/
+
+/**
+ * @brief  Switch to the PLL, as Core/Src/main.c does
+ * @retval None
+ */
+void SystemClock_Config(void)
+{
+    SystemCoreClock = SIM_PLL_CLOCK;
+}
+
+void MX_GPIO_Init(void)
+{
+}
+
+void MX_DMA_Init(void)
+{
+}
+
+void MX_UART4_Init(void)
+{
+    huart4.Instance = UART4;
+    huart4.Init.BaudRate = 921600;
+    huart4.gState = HAL_UART_STATE_READY;
+    huart4.RxState = HAL_UART_STATE_READY;
+}
+
+void MX_UART7_Init(void)
+{
+    hdma_uart7_rx.Instance = DMA1_Stream3;
+    hdma_uart7_rx.Init.Mode = DMA_CIRCULAR;
+
+    huart7.Instance = UART7;
+    /* The line runs at the simulated rate, the receiver sizes its waits by it */
+    huart7.Init.BaudRate = (simOptions.BaudRate != 0U) ? simOptions.BaudRate : 460800U;
+    huart7.hdmarx = &hdma_uart7_rx;
+    huart7.gState = HAL_UART_STATE_READY;
+    huart7.RxState = HAL_UART_STATE_READY;
+    hdma_uart7_rx.Parent = &huart7;
+}
+
+void Error_Handler(void)
+{
+    __disable_irq();
+    while (1)
+    {
+    }
+}
+
+/* HAL -----------------------------------------------------------------------*/
+
+HAL_StatusTypeDef HAL_Init(void)
+{
+    return HAL_OK;
+}
+
+uint32_t HAL_GetTick(void)
+{
+    return SimGetTick();
+}
+
+void HAL_Delay(uint32_t Delay)
+{
+    const uint32_t tickStart = HAL_GetTick();
+
+    while ((HAL_GetTick() - tickStart) < Delay)
+    {
+        SimSleep(100);
+    }
+}
+
+/* RCC and PWR ---------------------------------------------------------------*/
+
+HAL_StatusTypeDef HAL_RCC_DeInit(void)
+{
+    SystemCoreClock = HSI_VALUE;
+    return HAL_OK;
+}
+
+uint32_t HAL_RCC_GetSysClockFreq(void)
+{
+    return SystemCoreClock;
+}
+
+uint32_t HAL_RCC_GetPCLK1Freq(void)
+{
+    return (SystemCoreClock == SIM_PLL_CLOCK) ? (SystemCoreClock / 4U) : SystemCoreClock;
+}
+
+uint32_t HAL_RCC_GetPCLK2Freq(void)
+{
+    return (SystemCoreClock == SIM_PLL_CLOCK) ? (SystemCoreClock / 2U) : SystemCoreClock;
+}
+
+void HAL_PWR_EnableBkUpAccess(void)
+{
+    PWR->CR |= PWR_CR_DBP;
+}
+
+void HAL_PWR_DisableBkUpAccess(void)
+{
+    PWR->CR &= ~PWR_CR_DBP;
+}
+
+/* GPIO ----------------------------------------------------------------------*/
+
+/**
+ * @brief  Read a pin, the DIP switches follow the -m option
+ */
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin)
+{
+    if (((GPIOx == DIP1_GPIO_Port) && (GPIO_Pin == DIP1_Pin)) || ((GPIOx == DIP2_GPIO_Port) && (GPIO_Pin == DIP2_Pin)))
+    {
+        return (simOptions.MenuKeys != 0U) ? GPIO_PIN_RESET : GPIO_PIN_SET;
+    }
+
+    return GPIO_PIN_RESET;
+}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState)
+{
+    if (PinState == GPIO_PIN_SET)
+    {
+        GPIOx->ODR |= GPIO_Pin;
+    }
+    else
+    {
+        GPIOx->ODR &= ~(uint32_t)GPIO_Pin;
+    }
+}
+
+/* FLASH ---------------------------------------------------------------------*/
+
+HAL_StatusTypeDef HAL_FLASH_Unlock(void)
+{
+    FLASH->CR &= ~FLASH_CR_LOCK;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASH_Lock(void)
+{
+    FLASH->CR |= FLASH_CR_LOCK;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_FLASH_OB_Unlock(void)
+{
+    return HAL_OK;
+}
+
+/**
+ * @brief  Program a word, programming clears bits and never sets them
+ * @note   The store is timed and checked by the Flash trap of sim_device.c.
+ */
+HAL_StatusTypeDef HAL_FLASH_Program(uint32_t TypeProgram, uint32_t Address, uint64_t Data)
+{
+    const uint32_t size = 1UL << TypeProgram;
+
+    if (((FLASH->CR & FLASH_CR_LOCK) != 0U) || (Address < FLASH_BASE) ||
+        ((Address + size) > (FLASH_BASE + SIM_FLASH_SIZE)) || ((Address % size) != 0U))
+    {
+        FLASH->SR |= FLASH_SR_WRPERR;
+        return HAL_ERROR;
+    }
+
+    FLASH->CR |= FLASH_CR_PG;
+    switch (TypeProgram)
+    {
+    case FLASH_TYPEPROGRAM_BYTE:
+        *(__IO uint8_t *)Address &= (uint8_t)Data;
+        break;
+    case FLASH_TYPEPROGRAM_HALFWORD:
+        *(__IO uint16_t *)Address &= (uint16_t)Data;
+        break;
+    case FLASH_TYPEPROGRAM_WORD:
+        *(__IO uint32_t *)Address &= (uint32_t)Data;
+        break;
+    default:
+        *(__IO uint64_t *)Address &= Data;
+        break;
+    }
+    FLASH->CR &= ~FLASH_CR_PG;
+
+    return HAL_OK;
+}
+
+/**
+ * @brief  Erase sectors, blocking for the time the chip takes
+ */
+HAL_StatusTypeDef HAL_FLASHEx_Erase(FLASH_EraseInitTypeDef *pEraseInit, uint32_t *SectorError)
+{
+    uint32_t sector;
+
+    *SectorError = 0xFFFFFFFFU;
+    if ((FLASH->CR & FLASH_CR_LOCK) != 0U)
+    {
+        return HAL_ERROR;
+    }
+    if (pEraseInit->TypeErase == FLASH_TYPEERASE_MASSERASE)
+    {
+        return HAL_ERROR;
+    }
+
+    for (sector = pEraseInit->Sector; sector < (pEraseInit->Sector + pEraseInit->NbSectors); sector++)
+    {
+        if ((sector >= SIM_SECTOR_COUNT) || (SimFlashEraseStart(sector, 1, 0) != HAL_OK))
+        {
+            *SectorError = sector;
+            return HAL_ERROR;
+        }
+        while ((FLASH->SR & FLASH_SR_BSY) != 0U)
+        {
+            SimSleep(100);
+        }
+    }
+
+    return HAL_OK;
+}
+
+/**
+ * @brief  Erase sectors in the background, HAL_FLASH_EndOfOperationCallback()
+ *         follows from the device thread
+ */
+HAL_StatusTypeDef HAL_FLASHEx_Erase_IT(FLASH_EraseInitTypeDef *pEraseInit)
+{
+    if (((FLASH->CR & FLASH_CR_LOCK) != 0U) || (pEraseInit->TypeErase == FLASH_TYPEERASE_MASSERASE) ||
+        ((pEraseInit->Sector + pEraseInit->NbSectors) > SIM_SECTOR_COUNT) || (pEraseInit->NbSectors == 0U))
+    {
+        return HAL_ERROR;
+    }
+
+    return SimFlashEraseStart(pEraseInit->Sector, pEraseInit->NbSectors, 1);
+}
+
+void HAL_FLASHEx_OBGetConfig(FLASH_OBProgramInitTypeDef *pOBInit)
+{
+    memset(pOBInit, 0, sizeof(*pOBInit));
+    pOBInit->OptionType = OPTIONBYTE_WRP | OPTIONBYTE_RDP | OPTIONBYTE_USER | OPTIONBYTE_BOR;
+    pOBInit->WRPSector = 0xFFFU; /* nWRP set: nothing protected */
+    pOBInit->RDPLevel = OB_RDP_LEVEL_0;
+}
+
+HAL_StatusTypeDef HAL_FLASHEx_OBProgram(FLASH_OBProgramInitTypeDef *pOBInit)
+{
+    (void)pOBInit;
+    return HAL_OK;
+}
+
+/* Weak in the HAL, overridden by flash_if.c */
+__weak void HAL_FLASH_EndOfOperationCallback(uint32_t ReturnValue)
+{
+    (void)ReturnValue;
+}
+
+__weak void HAL_FLASH_OperationErrorCallback(uint32_t ReturnValue)
+{
+    (void)ReturnValue;
+}
+
+/* DMA -----------------------------------------------------------------------*/
+
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef *hdma)
+{
+    hdma->State = HAL_DMA_STATE_READY;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMA_DeInit(DMA_HandleTypeDef *hdma)
+{
+    hdma->State = HAL_DMA_STATE_RESET;
+    return HAL_OK;
+}
+
+/**
+ * @brief  Memory-to-memory transfer, done at once; CRC->DR as destination
+ *         feeds the CRC unit
+ */
+HAL_StatusTypeDef HAL_DMA_Start(DMA_HandleTypeDef *hdma, uint32_t SrcAddress, uint32_t DstAddress, uint32_t DataLength)
+{
+    if (hdma->Init.Direction != DMA_MEMORY_TO_MEMORY)
+    {
+        return HAL_ERROR;
+    }
+
+    if (DstAddress == (uint32_t)(uintptr_t)&CRC->DR)
+    {
+        SimCrcFeed((const uint32_t *)(uintptr_t)SrcAddress, DataLength);
+    }
+    else
+    {
+        memcpy((void *)(uintptr_t)DstAddress, (const void *)(uintptr_t)SrcAddress, DataLength * 4U);
+    }
+
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMA_PollForTransfer(DMA_HandleTypeDef *hdma, HAL_DMA_LevelCompleteTypeDef CompleteLevel,
+                                          uint32_t Timeout)
+{
+    (void)hdma;
+    (void)CompleteLevel;
+    (void)Timeout;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMA_Abort(DMA_HandleTypeDef *hdma)
+{
+    hdma->State = HAL_DMA_STATE_READY;
+    return HAL_OK;
+}
+
+/* UART ----------------------------------------------------------------------*/
+
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size, uint32_t Timeout)
+{
+    if (huart == &huart7)
+    {
+        SimUartWrite(pData, Size, Timeout);
+    }
+
+    return HAL_OK;
+}
+
+/**
+ * @brief  Transmission of the log on UART4, see SimLogWrite()
+ */
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, const uint8_t *pData, uint16_t Size)
+{
+    if (huart != &huart4)
+    {
+        return HAL_ERROR;
+    }
+    if (huart->gState != HAL_UART_STATE_READY)
+    {
+        return HAL_BUSY;
+    }
+
+    huart->gState = HAL_UART_STATE_BUSY_TX;
+    SimLogWrite(pData, Size);
+
+    return HAL_OK;
+}
+
+/**
+ * @brief  Circular reception of UART7 into a ring, see SimUartStart()
+ */
+HAL_StatusTypeDef HAL_UARTEx_ReceiveToIdle_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size)
+{
+    if ((huart != &huart7) || (huart->RxState != HAL_UART_STATE_READY))
+    {
+        return HAL_ERROR;
+    }
+
+    huart->RxState = HAL_UART_STATE_BUSY_RX;
+    huart->ReceptionType = HAL_UART_RECEPTION_TOIDLE;
+    SimUartStart(pData, Size);
+
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_AbortReceive(UART_HandleTypeDef *huart)
+{
+    if (huart == &huart7)
+    {
+        SimUartStop();
+    }
+    huart->RxState = HAL_UART_STATE_READY;
+
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_DeInit(UART_HandleTypeDef *huart)
+{
+    (void)HAL_UART_AbortReceive(huart);
+    huart->gState = HAL_UART_STATE_RESET;
+    huart->RxState = HAL_UART_STATE_RESET;
+
+    return HAL_OK;
+}
+
+/* Weak in the HAL, overridden by serial_rx.c */
+__weak void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size)
+{
+    (void)huart;
+    (void)Size;
+}
+
+/* Weak in the HAL, overridden by log.c */
+__weak void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+    (void)huart;
+}
@@ -0,0 +1,146 @@
+/* USER CODE BEGIN Header */
+/**
+ ******************************************************************************
+ * @file           : sim_main.c
+ * @brief          : Entry point of the host simulation
+ *
+ *          Runs the start-up sequence of Core/Src/main.c on the simulated
+ *          board. printf() goes to the log ring as __io_putchar() does on the
+ *          chip, and from there to stderr like the simulation's own reports.
+ *
+ *          Usage: bootsim [-f board.bin] [-l link] [-b baud] [-e percent] [-p percent] [-m]
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2025 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+/* USER CODE END Header */
+
+/* Includes ------------------------------------------------------------------*/
+#define _GNU_SOURCE
+#include "boot_main.h"
+#include "dma.h"
+#include "gpio.h"
+#include "log.h"
+#include "sim.h"
+#include "usart.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/* Exported variables --------------------------------------------------------*/
+SimOptions simOptions = {"board.bin", NULL, 460800, 100, 100, 0, -1};
+
+/* Private function prototypes -----------------------------------------------*/
+static void SimUsage(const char *name);
+static void SimParseOptions(int argc, char *argv[]);
+static ssize_t SimStdoutWrite(void *cookie, const char *data, size_t size);
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Print the command line help and exit
+ * @param  name: program name
+ * @retval None
+ */
+static void SimUsage(const char *name)
+{
+    fprintf(stderr,
+            "Usage: %s [-f board.bin] [-l link] [-b baud] [-e percent] [-p percent] [-m]\n"
+            "  -f  board file with the 2 MB Flash and the backup domain, created erased (board.bin)\n"
+            "  -l  symlink to create to the UART7 pty, for the sender to open\n"
+            "  -b  UART7 receive rate, 0 for as fast as the pty delivers (460800)\n"
+            "  -e  sector erase time in percent of the typical one, 0 for instant (100)\n"
+            "  -p  word programming time in percent of the typical 16 us, x86-64 only (100)\n"
+            "  -m  hold DIP1 and DIP2: stay in the menu, also after each update\n",
+            name);
+    exit(EXIT_FAILURE);
+}
+
+/**
+ * @brief  Read the command line into simOptions
+ * @param  argc: argument count
+ * @param  argv: arguments
+ * @retval None
+ */
+static void SimParseOptions(int argc, char *argv[])
+{
+    int option;
+
+    while ((option = getopt(argc, argv, "f:l:b:e:p:mh")) != -1)
+    {
+        switch (option)
+        {
+        case 'f':
+            simOptions.FlashPath = optarg;
+            break;
+        case 'l':
+            simOptions.LinkPath = optarg;
+            break;
+        case 'b':
+            simOptions.BaudRate = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'e':
+            simOptions.EraseScale = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'p':
+            simOptions.ProgramScale = (uint32_t)strtoul(optarg, NULL, 0);
+            break;
+        case 'm':
+            simOptions.MenuKeys = 1;
+            break;
+        default:
+            SimUsage(argv[0]);
+            break;
+        }
+    }
+}
+
+/**
+ * @brief  stdout of the bootloader, queued for UART4
+ * @param  cookie: unused
+ * @param  data: bytes
+ * @param  size: number of bytes
+ * @retval size
+ */
+static ssize_t SimStdoutWrite(void *cookie, const char *data, size_t size)
+{
+    (void)cookie;
+    LogWrite((const uint8_t *)data, (uint32_t)size);
+
+    return (ssize_t)size;
+}
+
+/* Public functions ----------------------------------------------------------*/
+
+int main(int argc, char *argv[])
+{
+    const cookie_io_functions_t uart = {NULL, SimStdoutWrite, NULL, NULL};
+
+    SimParseOptions(argc, argv);
+    SimDeviceInit(argv);
+
+    stdout = fopencookie(NULL, "w", uart);
+    setvbuf(stdout, NULL, _IONBF, 0);
+
+    /* As Core/Src/main.c */
+    BootFastPath();
+    HAL_Init();
+    SystemClock_Config();
+    BootClockReady();
+    MX_GPIO_Init();
+    MX_DMA_Init();
+    MX_UART4_Init();
+    MX_UART7_Init();
+    boot_main();
+
+    return 0;
+}
@@ -0,0 +1,424 @@
+/* USER CODE BEGIN Header */
+/**
+ ******************************************************************************
+ * @file           : store_test.c
+ * @brief          : store.c on an emulated Flash area
+ *
+ *          The store runs on a small area in RAM that behaves like NOR Flash:
+ *          programming can only clear bits and an erase sets the whole area
+ *          back to 0xFF. Every step is checked against the values the store
+ *          returns and against a fresh StoreInit(), which replays the log as
+ *          a reset would. Covers appending, the last record of a key winning,
+ *          records torn by a reset, the compaction of a full area and a reset
+ *          during the compaction, which the copy kept by the Backup hook
+ *          undoes.
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2025 STMicroelectronics.
+ * All rights reserved.
+ *
+ * This software is licensed under terms that can be found in the LICENSE file
+ * in the root directory of this software component.
+ * If no LICENSE file comes with this software, it is provided AS-IS.
+ *
+ ******************************************************************************
+ */
+/* USER CODE END Header */
+
+/* Includes ------------------------------------------------------------------*/
+#include "sim.h"
+#include "store.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+/* Private define ------------------------------------------------------------*/
+#define TEST_AREA_WORDS 32U
+#define TEST_COPY_WORDS 16U
+#define TEST_BLANK 0xFFFFFFFFUL
+
+/* Private macro -------------------------------------------------------------*/
+#define TEST_CHECK(condition) TestCheck((condition), #condition, __LINE__)
+#define TEST_ADDRESS(index) ((uint32_t)(uintptr_t)&aTestFlash[(index)])
+/* Record layout of store.c: key (31:24), value (23:8), check (7:0) */
+#define TEST_RECORD(key, value)                                                                                        \
+    (((uint32_t)(key) << 24) | ((uint32_t)(value) << 8) | (uint8_t)((key) ^ ((value) >> 8) ^ (value) ^ 0xA5U))
+
+/* Private function prototypes -----------------------------------------------*/
+static uint32_t TestProgram(uint32_t address, uint32_t word);
+static uint32_t TestErase(void);
+static uint32_t TestBackup(const StoreWord *words, uint32_t count);
+static uint32_t TestRecover(StoreWord *words, uint32_t max);
+
+/* Private variables ---------------------------------------------------------*/
+/* Not used, the device is not started */
+SimOptions simOptions = {NULL, NULL, 460800, 100, 100, 0, -1};
+
+static uint32_t aTestFlash[TEST_AREA_WORDS];
+static StoreArea testArea;
+static uint32_t testPrograms;
+static uint32_t testErases;
+static uint32_t testEraseFails; /* Number of erases to fail from now on */
+static uint32_t testProgramsLeft; /* Programs before a reset, none is written after it */
+static StoreWord aTestCopy[TEST_COPY_WORDS];
+static uint32_t testCopyCount;
+static uint32_t testBackupFails;
+static uint32_t testChecks;
+static uint32_t testFailures;
+
+/* Private functions ---------------------------------------------------------*/
+
+/**
+ * @brief  Program a word of the emulated area, only clearing bits
+ * @param  address: word address in the area
+ * @param  word: value to program
+ * @retval STORE_OK, STORE_WRITE_ERROR if the word was not erased
+ */
+static uint32_t TestProgram(uint32_t address, uint32_t word)
+{
+    const uint32_t index = (address - TEST_ADDRESS(0)) / 4U;
+
+    if ((address < testArea.Start) || (address >= testArea.End) || ((address % 4U) != 0U))
+    {
+        printf("program outside the area at 0x%08X\n", address);
+        testFailures++;
+        return STORE_WRITE_ERROR;
+    }
+
+    if (testProgramsLeft == 0U)
+    {
+        return STORE_WRITE_ERROR;
+    }
+    testProgramsLeft--;
+
+    testPrograms++;
+    aTestFlash[index] &= word;
+
+    return (aTestFlash[index] == word) ? STORE_OK : STORE_WRITE_ERROR;
+}
+
+/**
+ * @brief  Erase the emulated area
+ * @retval STORE_OK, STORE_ERASE_ERROR while erases are set to fail
+ */
+static uint32_t TestErase(void)
+{
+    uint32_t i;
+
+    if (testEraseFails > 0U)
+    {
+        testEraseFails--;
+        return STORE_ERASE_ERROR;
+    }
+
+    testErases++;
+    for (i = 0; i < TEST_AREA_WORDS; i++)
+    {
+        aTestFlash[i] = TEST_BLANK;
+    }
+
+    return STORE_OK;
+}
+
+/**
+ * @brief  Keep a copy of the words outside the area
+ * @param  words: words to keep
+ * @param  count: number of words, 0 to drop the copy
+ * @retval STORE_OK, STORE_WRITE_ERROR while the copy is set to fail
+ */
+static uint32_t TestBackup(const StoreWord *words, uint32_t count)
+{
+    uint32_t i;
+
+    if ((testBackupFails != 0U) || (count > TEST_COPY_WORDS))
+    {
+        return STORE_WRITE_ERROR;
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        aTestCopy[i] = words[i];
+    }
+    testCopyCount = count;
+
+    return STORE_OK;
+}
+
+/**
+ * @brief  Read the copy back
+ * @param  words: filled with the copy
+ * @param  max: room in words
+ * @retval Number of words, 0 if the copy was dropped
+ */
+static uint32_t TestRecover(StoreWord *words, uint32_t max)
+{
+    uint32_t i;
+
+    if (testCopyCount > max)
+    {
+        return 0;
+    }
+    for (i = 0; i < testCopyCount; i++)
+    {
+        words[i] = aTestCopy[i];
+    }
+
+    return testCopyCount;
+}
+
+/**
+ * @brief  Count a check and report it if it failed
+ * @param  condition: result of the check
+ * @param  text: the check as written
+ * @param  line: source line
+ * @retval None
+ */
+static void TestCheck(int condition, const char *text, int line)
+{
+    testChecks++;
+    if (!condition)
+    {
+        printf("store_test.c:%d: failed: %s\n", line, text);
+        testFailures++;
+    }
+}
+
+/**
+ * @brief  Replay the area as after a reset
+ * @retval None
+ */
+static void TestReset(void)
+{
+    StoreInit(&testArea);
+}
+
+/**
+ * @brief  A new area and a store that starts empty
+ * @retval None
+ */
+static void TestAppend(void)
+{
+    (void)TestErase();
+    testPrograms = 0;
+    TestReset();
+
+    TEST_CHECK(StoreGetFree() == TEST_AREA_WORDS);
+    TEST_CHECK(StoreGet(STORE_KEY_UPGRADE, 7) == 7);
+
+    /* One word per change, none for an unchanged value */
+    TEST_CHECK(StoreSet(STORE_KEY_UPGRADE, 1) == STORE_OK);
+    TEST_CHECK(StoreSet(STORE_KEY_UPGRADE, 1) == STORE_OK);
+    TEST_CHECK(StoreIncrement(STORE_KEY_UPDATES) == STORE_OK);
+    TEST_CHECK(testPrograms == 2);
+    TEST_CHECK(StoreGetFree() == (TEST_AREA_WORDS - 2U));
+    TEST_CHECK(aTestFlash[2] == TEST_BLANK);
+
+    /* Key 0 and keys past the last one are refused */
+    TEST_CHECK(StoreSet(0, 1) != STORE_OK);
+    TEST_CHECK(StoreSet(STORE_KEY_COUNT, 1) != STORE_OK);
+    TEST_CHECK(testPrograms == 2);
+
+    TestReset();
+    TEST_CHECK(StoreGet(STORE_KEY_UPGRADE, 0) == 1);
+    TEST_CHECK(StoreGet(STORE_KEY_UPDATES, 0) == 1);
+    TEST_CHECK(StoreGet(STORE_KEY_ROLLBACKS, 0xFFFF) == 0xFFFF);
+    TEST_CHECK(StoreGetFree() == (TEST_AREA_WORDS - 2U));
+}
+
+/**
+ * @brief  Several records of a key, the last one counts
+ * @retval None
+ */
+static void TestLastRecordWins(void)
+{
+    (void)TestErase();
+    TestReset();
+
+    TEST_CHECK(StoreSet(STORE_KEY_ROLLBACKS, 0x1234) == STORE_OK);
+    TEST_CHECK(StoreSet(STORE_KEY_UPGRADE, 1) == STORE_OK);
+    TEST_CHECK(StoreSet(STORE_KEY_ROLLBACKS, 0xFFFF) == STORE_OK);
+    TEST_CHECK(StoreSet(STORE_KEY_UPGRADE, 0) == STORE_OK);
+    TEST_CHECK(StoreIncrement(STORE_KEY_ROLLBACKS) == STORE_OK);
+    TEST_CHECK(StoreGet(STORE_KEY_ROLLBACKS, 1) == 0);
+    TEST_CHECK(StoreGet(STORE_KEY_UPGRADE, 1) == 0);
+
+    TestReset();
+    TEST_CHECK(StoreGet(STORE_KEY_ROLLBACKS, 1) == 0);
+    TEST_CHECK(StoreGet(STORE_KEY_UPGRADE, 1) == 0);
+    TEST_CHECK(StoreGetFree() == (TEST_AREA_WORDS - 5U));
+}
+
+/**
+ * @brief  Records cut short by a reset are skipped, the log goes on after them
+ * @retval None
+ */
+static void TestTornRecord(void)
+{
+    uint32_t next;
+
+    (void)TestErase();
+    TestReset();
+
+    TEST_CHECK(StoreSet(STORE_KEY_UPDATES, 10) == STORE_OK);
+    next = TEST_AREA_WORDS - StoreGetFree();
+
+    /* Resets while programming left bits at 1: the check byte, then a value
+       bit. Then a complete record of a key that does not exist. */
+    aTestFlash[next] = TEST_RECORD(STORE_KEY_UPDATES, 11U) | 0xFFU;
+    aTestFlash[next + 1U] = TEST_RECORD(STORE_KEY_UPDATES, 11U) | (1UL << 10);
+    aTestFlash[next + 2U] = TEST_RECORD(0x7FU, 11U);
+
+    TestReset();
+    TEST_CHECK(StoreGet(STORE_KEY_UPDATES, 0) == 10);
+    TEST_CHECK(StoreGetFree() == (TEST_AREA_WORDS - next - 3U));
+
+    /* New records go after the torn ones and win */
+    TEST_CHECK(StoreIncrement(STORE_KEY_UPDATES) == STORE_OK);
+    TEST_CHECK(aTestFlash[next + 3U] != TEST_BLANK);
+    TestReset();
+    TEST_CHECK(StoreGet(STORE_KEY_UPDATES, 0) == 11);
+}
+
+/**
+ * @brief  A full area is erased once and the current values written back
+ * @retval None
+ */
+static void TestCompaction(void)
+{
+    uint32_t i, erases;
+
+    (void)TestErase();
+    TestReset();
+
+    TEST_CHECK(StoreSet(STORE_KEY_UPGRADE, 1) == STORE_OK);
+    TEST_CHECK(StoreSet(STORE_KEY_ROLLBACKS, 42) == STORE_OK);
+
+    /* Fill the area with counter updates */
+    erases = testErases;
+    for (i = 2; i < TEST_AREA_WORDS; i++)
+    {
+        TEST_CHECK(StoreIncrement(STORE_KEY_UPDATES) == STORE_OK);
+    }
+    TEST_CHECK(StoreGetFree() == 0);
+    TEST_CHECK(testErases == erases);
+
+    /* The next update compacts: three keys, the new value included */
+    TEST_CHECK(StoreIncrement(STORE_KEY_UPDATES) == STORE_OK);
+    TEST_CHECK(testErases == (erases + 1U));
+    TEST_CHECK(StoreGetFree() == (TEST_AREA_WORDS - 3U));
+    TEST_CHECK(StoreGet(STORE_KEY_UPDATES, 0) == (TEST_AREA_WORDS - 1U));
+
+    TestReset();
+    TEST_CHECK(StoreGet(STORE_KEY_UPGRADE, 0) == 1);
+    TEST_CHECK(StoreGet(STORE_KEY_ROLLBACKS, 0) == 42);
+    TEST_CHECK(StoreGet(STORE_KEY_UPDATES, 0) == (TEST_AREA_WORDS - 1U));
+    TEST_CHECK(StoreGetFree() == (TEST_AREA_WORDS - 3U));
+
+    /* Many updates: the free words fill up, the next update erases */
+    erases = testErases;
+    for (i = 0; i < (10U * (TEST_AREA_WORDS - 2U)); i++)
+    {
+        TEST_CHECK(StoreIncrement(STORE_KEY_UPDATES) == STORE_OK);
+    }
+    TEST_CHECK(testErases == (erases + 10U));
+    TestReset();
+    TEST_CHECK(StoreGet(STORE_KEY_UPDATES, 0) == ((TEST_AREA_WORDS - 1U) + (10U * (TEST_AREA_WORDS - 2U))));
+
+    /* A failed copy is reported before anything is erased */
+    for (i = StoreGetFree(); i > 0U; i--)
+    {
+        TEST_CHECK(StoreIncrement(STORE_KEY_ROLLBACKS) == STORE_OK);
+    }
+    erases = testErases;
+    testBackupFails = 1;
+    TEST_CHECK(StoreSet(STORE_KEY_UPGRADE, 0) == STORE_WRITE_ERROR);
+    testBackupFails = 0;
+    TEST_CHECK(testErases == erases);
+    TestReset();
+    TEST_CHECK(StoreGet(STORE_KEY_UPGRADE, 0) == 1);
+    TEST_CHECK(StoreGet(STORE_KEY_ROLLBACKS, 0) == (42U + TEST_AREA_WORDS - 3U));
+
+    /* A failed erase is reported, the copy is written back on the next read */
+    testEraseFails = 1;
+    TEST_CHECK(StoreSet(STORE_KEY_UPGRADE, 0) == STORE_ERASE_ERROR);
+    TEST_CHECK(testCopyCount == 3);
+    TestReset();
+    TEST_CHECK(testCopyCount == 0);
+    TEST_CHECK(StoreGet(STORE_KEY_UPGRADE, 1) == 0);
+    TEST_CHECK(StoreGet(STORE_KEY_ROLLBACKS, 0) == (42U + TEST_AREA_WORDS - 3U));
+    TEST_CHECK(StoreGetFree() == (TEST_AREA_WORDS - 3U));
+    TEST_CHECK(StoreSet(STORE_KEY_UPGRADE, 1) == STORE_OK);
+    TEST_CHECK(StoreGet(STORE_KEY_UPGRADE, 0) == 1);
+}
+
+/**
+ * @brief  A reset at any point of the compaction loses no value
+ * @retval None
+ */
+static void TestCompactionReset(void)
+{
+    uint32_t i, left, erases;
+
+    for (left = 0; left <= 3U; left++)
+    {
+        (void)TestErase();
+        TestReset();
+        TEST_CHECK(StoreSet(STORE_KEY_UPGRADE, 1) == STORE_OK);
+        TEST_CHECK(StoreSet(STORE_KEY_ROLLBACKS, 42) == STORE_OK);
+        for (i = 2; i < TEST_AREA_WORDS; i++)
+        {
+            TEST_CHECK(StoreIncrement(STORE_KEY_UPDATES) == STORE_OK);
+        }
+
+        /* The erase is done, then only left records are written */
+        erases = testErases;
+        testProgramsLeft = left;
+        TEST_CHECK(StoreIncrement(STORE_KEY_UPDATES) == ((left < 3U) ? STORE_WRITE_ERROR : STORE_OK));
+        testProgramsLeft = UINT32_MAX;
+        TEST_CHECK(testErases == (erases + 1U));
+        TEST_CHECK(testCopyCount == ((left < 3U) ? 3U : 0U));
+        if (left == 0U)
+        {
+            /* Nothing of the store is left in the area */
+            TEST_CHECK(aTestFlash[0] == TEST_BLANK);
+        }
+
+        /* The copy is written back with UPGRADE first, then dropped */
+        TestReset();
+        TEST_CHECK(testErases == (erases + ((left < 3U) ? 2U : 1U)));
+        TEST_CHECK(testCopyCount == 0);
+        TEST_CHECK(aTestFlash[0] == TEST_RECORD(STORE_KEY_UPGRADE, 1U));
+        TEST_CHECK(StoreGet(STORE_KEY_UPGRADE, 0) == 1);
+        TEST_CHECK(StoreGet(STORE_KEY_ROLLBACKS, 0) == 42);
+        TEST_CHECK(StoreGet(STORE_KEY_UPDATES, 0) == (TEST_AREA_WORDS - 1U));
+        TEST_CHECK(StoreGetFree() == (TEST_AREA_WORDS - 3U));
+
+        /* Nothing to recover on the next reset */
+        TestReset();
+        TEST_CHECK(testErases == (erases + ((left < 3U) ? 2U : 1U)));
+    }
+}
+
+/* Public functions ----------------------------------------------------------*/
+
+int main(void)
+{
+    testArea.Start = TEST_ADDRESS(0);
+    testArea.End = TEST_ADDRESS(TEST_AREA_WORDS);
+    testArea.Program = TestProgram;
+    testArea.Erase = TestErase;
+    testArea.Backup = TestBackup;
+    testArea.Recover = TestRecover;
+    testProgramsLeft = UINT32_MAX;
+
+    TestAppend();
+    TestLastRecordWins();
+    TestTornRecord();
+    TestCompaction();
+    TestCompactionReset();
+
+    printf("store: %u checks, %u failed\n", testChecks, testFailures);
+
+    return (testFailures == 0U) ? 0 : 1;
+}